@@ -0,0 +1,59 @@
+#include "candidate_cache.hpp"
+#include <utility>
+
+void candidate_cache::reset(int pairs) {
+    for (int i = 0; i < static_cast<int>(entries_.size()); ++i) release(i);
+    entries_.resize(pairs);
+    newest_ = oldest_ = -1;
+    stats_.bytes = 0;
+}
+
+void candidate_cache::unlink(int pair) {
+    entry &en = entries_[pair];
+    (en.newer >= 0 ? entries_[en.newer].older : newest_) = en.older;
+    (en.older >= 0 ? entries_[en.older].newer : oldest_) = en.newer;
+    en.newer = en.older = -1;
+}
+
+void candidate_cache::push_front(int pair) {
+    entry &en = entries_[pair];
+    en.older = newest_;
+    en.newer = -1;
+    (newest_ >= 0 ? entries_[newest_].newer : oldest_) = pair;
+    newest_ = pair;
+}
+
+void candidate_cache::release(int pair) {
+    entry &en = entries_[pair];
+    if (!en.ready) return;
+    unlink(pair);
+    stats_.bytes -= en.bytes();
+    // swap із порожнім вектором справді повертає пам'ять
+    std::vector<int>().swap(en.blocked);
+    std::vector<int>().swap(en.cells);
+    en.size = 0;
+    en.ready = false;
+}
+
+void candidate_cache::store(int pair, std::vector<int> &&blocked, std::vector<int> &&cells, int size) {
+    release(pair);
+    entry &en = entries_[pair];
+    en.blocked = std::move(blocked);
+    en.cells = std::move(cells);
+    en.size = size;
+    std::size_t need = en.bytes();
+    if (need > max_bytes_) {
+        std::vector<int>().swap(en.blocked);
+        std::vector<int>().swap(en.cells);
+        return;
+    }
+
+    // Витісняємо найдавніше використані записи з хвоста списку, доки новий не вміститься
+    while (stats_.bytes + need > max_bytes_ && oldest_ >= 0) {
+        release(oldest_);
+        stats_.evictions++;
+    }
+    en.ready = true;
+    push_front(pair);
+    stats_.bytes += need;
+}
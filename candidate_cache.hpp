@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/*
+    Кеш островів-кандидатів кожної пари на час одного розв'язання.
+
+    Для пари зберігаються клітинки всіх її островів (без перевірок 2x2 і зв'язності, які залежать від усієї сітки)
+    і знімок чорних клітинок досяжної області пари на момент перебору. Перебір залежить лише від чорних клітинок,
+    тож поки всі клітинки знімка залишаються чорними, нові острови з'явитися не можуть - нові чорні клітинки
+    лише забирають кандидатів, і достатньо відкинути тих, що їх зачіпають. Заповнені клітинки розміщених островів
+    оточені чорними, тому окремо не відстежуються. Якщо хоч одна клітинка знімка перестала бути чорною
+    (пошук повернувся вище за точку перебору), запис застарів і пару треба перебрати заново.
+
+    Обсяг пам'яті обмежений: при перевищенні витісняються записи, які найдовше не використовувалися.
+    Записи зв'язані в інтрузивний список за часом використання, тож і оновлення, і витіснення - O(1)
+*/
+class candidate_cache {
+public:
+    struct entry {
+        std::vector<int> blocked;   // чорні клітинки досяжної області на момент перебору
+        std::vector<int> cells;     // клітинки кандидатів підряд, по size на кандидата
+        int size = 0;               // кількість клітинок у кандидаті
+        int newer = -1, older = -1; // сусіди в списку за часом використання
+        bool ready = false;
+
+        int count() const { return size ? static_cast<int>(cells.size()) / size : 0; }
+        std::size_t bytes() const { return sizeof(entry) + (blocked.capacity() + cells.capacity()) * sizeof(int); }
+    };
+
+    struct statistics {
+        long long hits = 0;         // кандидати взято з кешу
+        long long misses = 0;       // запису не було
+        long long stale = 0;        // запис застарів
+        long long evictions = 0;    // записи, витіснені через обмеження пам'яті
+        std::size_t bytes = 0;      // поточний обсяг записів
+    };
+
+    explicit candidate_cache(std::size_t max_bytes = std::size_t(64) << 20) : max_bytes_(max_bytes) {}
+
+    // Очищує записи для нового розв'язання з pairs парами (статистика зберігається)
+    void reset(int pairs);
+
+    void set_limit(std::size_t max_bytes) { max_bytes_ = max_bytes; }
+
+    /*
+        Запис пари, якщо він є і досі дійсний: still_blocked(id) має повертати true (клітинка досі чорна)
+        для кожної клітинки знімка.
+        Застарілий запис звільняється. Повертає nullptr, якщо пару треба перебрати
+    */
+    template <class Blocked>
+    const entry *lookup(int pair, Blocked still_blocked) {
+        entry &en = entries_[pair];
+        if (!en.ready) {
+            stats_.misses++;
+            return nullptr;
+        }
+        for (int id : en.blocked) {
+            if (!still_blocked(id)) {
+                release(pair);
+                stats_.stale++;
+                return nullptr;
+            }
+        }
+        unlink(pair);
+        push_front(pair);
+        stats_.hits++;
+        return &en;
+    }
+
+    /*
+        Зберігає перебір пари; для витіснення обирається запис, який найдовше не використовувався.
+        Запис, більший за все обмеження, не зберігається
+    */
+    void store(int pair, std::vector<int> &&blocked, std::vector<int> &&cells, int size);
+
+    const statistics &stats() const { return stats_; }
+
+private:
+    std::vector<entry> entries_;
+    std::size_t max_bytes_;
+    int newest_ = -1, oldest_ = -1;     // кінці списку за часом використання
+    statistics stats_;
+
+    void release(int pair);
+    void unlink(int pair);
+    void push_front(int pair);
+};
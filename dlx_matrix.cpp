@@ -0,0 +1,111 @@
+#include "dlx_matrix.hpp"
+#include <stdexcept>
+
+dlx_matrix::dlx_matrix(int primary, int secondary) {
+    int columns = primary + secondary;
+    left_.resize(columns + 1);
+    right_.resize(columns + 1);
+    up_.resize(columns + 1);
+    down_.resize(columns + 1);
+    column_.resize(columns + 1);
+    row_.assign(columns + 1, -1);
+    size_.assign(columns + 1, 0);
+
+    for (int c = 0; c <= columns; ++c) {
+        up_[c] = down_[c] = column_[c] = c;
+        left_[c] = right_[c] = c;
+    }
+    // Основні стовпці зв'язуємо в кільце з коренем, додаткові залишаються замкненими самі на себе
+    for (int c = 1; c <= primary; ++c) {
+        left_[c] = c - 1;
+        right_[c - 1] = c;
+    }
+    left_[0] = primary;
+    right_[primary] = 0;
+}
+
+int dlx_matrix::new_node(int column, int row) {
+    int id = static_cast<int>(left_.size());
+    left_.push_back(id);
+    right_.push_back(id);
+    // Вставляємо вузол у низ стовпця
+    up_.push_back(up_[column]);
+    down_.push_back(column);
+    down_[up_[column]] = id;
+    up_[column] = id;
+    column_.push_back(column);
+    row_.push_back(row);
+    size_[column]++;
+    return id;
+}
+
+int dlx_matrix::add_row(const std::vector<int> &columns) {
+    if (columns.empty()) {
+        throw std::invalid_argument("Рядок матриці покриття не може бути порожнім");
+    }
+    int row = rows_++;
+    int first = -1;
+    for (int col : columns) {
+        int id = new_node(col + 1, row);
+        if (first < 0) {
+            first = id;
+            continue;
+        }
+        // Вставляємо вузол ліворуч від першого, тобто в кінець кільця рядка
+        left_[id] = left_[first];
+        right_[id] = first;
+        right_[left_[first]] = id;
+        left_[first] = id;
+    }
+    return row;
+}
+
+void dlx_matrix::cover(int c) {
+    right_[left_[c]] = right_[c];
+    left_[right_[c]] = left_[c];
+    for (int i = down_[c]; i != c; i = down_[i]) {
+        for (int j = right_[i]; j != i; j = right_[j]) {
+            down_[up_[j]] = down_[j];
+            up_[down_[j]] = up_[j];
+            size_[column_[j]]--;
+        }
+    }
+}
+
+void dlx_matrix::uncover(int c) {
+    for (int i = up_[c]; i != c; i = up_[i]) {
+        for (int j = left_[i]; j != i; j = left_[j]) {
+            size_[column_[j]]++;
+            down_[up_[j]] = j;
+            up_[down_[j]] = j;
+        }
+    }
+    right_[left_[c]] = c;
+    left_[right_[c]] = c;
+}
+
+bool dlx_matrix::search(const dlx_callbacks &cb) {
+    return search(cb, 0);
+}
+
+bool dlx_matrix::search(const dlx_callbacks &cb, int depth) {
+    if (right_[0] == 0) return cb.accept_cover(depth);
+
+    // MRV: обираємо основний стовпець з найменшою кількістю рядків, при рівності - перший
+    int best = right_[0];
+    for (int c = right_[best]; c != 0; c = right_[c]) {
+        if (size_[c] < size_[best]) best = c;
+    }
+    // Стовпець, який уже нічим не покрити, - часткове покриття безнадійне
+    if (size_[best] == 0) return false;
+
+    cover(best);
+    bool found = false;
+    for (int r = down_[best]; r != best && !found; r = down_[r]) {
+        for (int j = right_[r]; j != r; j = right_[j]) cover(column_[j]);
+        found = cb.try_row(row_[r], depth, [&] { return search(cb, depth + 1); });
+        for (int j = left_[r]; j != r; j = left_[j]) uncover(column_[j]);
+    }
+    uncover(best);
+    return found;
+}
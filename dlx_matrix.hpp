@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+/*
+    Розріджена матриця точного покриття на "танцюючих посиланнях" (алгоритм X Кнута).
+    Основні стовпці мають бути покриті рівно один раз, додаткові - не більше одного разу.
+    Пошук сам обирає стовпець з найменшою кількістю рядків (MRV), а рішення про те, чи приймати
+    рядок і часткове покриття, делегує викликам dlx_callbacks
+*/
+class dlx_matrix {
+public:
+    struct dlx_callbacks {
+        /*
+            Викликається для кожного рядка обраного стовпця, коли його стовпці вже покрито.
+            descend() продовжує пошук на наступній глибині і повертає true, якщо знайдено повне покриття
+        */
+        std::function<bool(int row, int depth, const std::function<bool()> &descend)> try_row;
+        // Викликається, коли покрито всі основні стовпці; false означає, що покриття відхилено
+        std::function<bool(int depth)> accept_cover;
+    };
+
+    // Створює матрицю з primary основними і secondary додатковими стовпцями
+    dlx_matrix(int primary, int secondary = 0);
+
+    // Додає рядок, що покриває вказані стовпці (індекси основних стовпців йдуть першими), повертає його номер
+    int add_row(const std::vector<int> &columns);
+
+    // Кількість рядків, які зараз залишилися в стовпці
+    int column_size(int column) const { return size_[column + 1]; }
+
+    int row_count() const { return rows_; }
+
+    // Запускає пошук точного покриття
+    bool search(const dlx_callbacks &cb);
+
+private:
+    // Вузол 0 - корінь, вузли 1..columns - заголовки стовпців, далі - вузли рядків
+    std::vector<int> left_, right_, up_, down_, column_, row_;
+    std::vector<int> size_;
+    int rows_ = 0;
+
+    int new_node(int column, int row);
+    void cover(int c);
+    void uncover(int c);
+    bool search(const dlx_callbacks &cb, int depth);
+};
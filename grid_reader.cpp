@@ -1,6 +1,13 @@
 #include "grid_reader.hpp"
 #include <limits>
 #include <fstream>
+#include <charconv>
+#include <string_view>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // Зчитування сітки з консолі
 grid_data grid_reader::from_console(std::istream &in, std::ostream &out) {
@@ -107,7 +114,11 @@ grid_data grid_reader::from_file(const std::string &filepath) {
     if (!fin) {
         throw std::runtime_error("Не вдалося відкрити файл " + filepath);
     }
+    return from_stream(fin);
+}
 
+// Зчитування сітки з потоку
+grid_data grid_reader::from_stream(std::istream &fin) {
     // Перші 2 числа - розмірі сітки
     grid_data data;
     if (!(fin >> data.rows >> data.cols) || data.rows <= 0 || data.cols <= 0) {
@@ -126,3 +137,258 @@ grid_data grid_reader::from_file(const std::string &filepath) {
 
     return data;
 }
+
+// Перевірка підказок задачі
+std::string grid_reader::validate(const grid_data &data) {
+    const int cells = data.rows * data.cols;
+    auto where = [](int r, int c) {
+        return " (рядок " + std::to_string(r + 1) + ", стовпець " + std::to_string(c + 1) + ")";
+    };
+    int hint_count = 0;
+    long long hint_sum = 0;
+    for (int r = 0; r < data.rows; ++r) {
+        for (int c = 0; c < data.cols; ++c) {
+            int v = data.grid[r][c];
+            if (v == 0) continue;
+            if (v < 0) return "від'ємне значення" + where(r, c);
+            if (v > cells) return "значення завелике для сітки" + where(r, c);
+            if ((c > 0 && data.grid[r][c - 1] > 0) || (r > 0 && data.grid[r - 1][c] > 0)) {
+                return "сусідні підказки" + where(r, c);
+            }
+            hint_count++;
+            hint_sum += v;
+        }
+    }
+    if (hint_count % 2 != 0) return "кількість підказок має бути парною";
+    if (hint_sum > cells) return "сума підказок перевищує кількість клітинок";
+    return "";
+}
+
+puzzle_stream::puzzle_stream(const std::string &path, bool check_clues) : check_clues_(check_clues) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Не вдалося відкрити файл " + path);
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) < 0) {
+        ::close(fd_);
+        throw std::runtime_error("Не вдалося прочитати файл " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    // Порожній файл не відображається, у ньому просто немає задач
+    if (size_ > 0) {
+        void *map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("Не вдалося відобразити файл " + path);
+        }
+        ::madvise(map, size_, MADV_SEQUENTIAL);
+        map_ = static_cast<char *>(map);
+    }
+    pos_ = map_;
+    end_ = map_ + size_;
+}
+
+puzzle_stream::~puzzle_stream() {
+    if (map_) ::munmap(map_, size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool puzzle_stream::at_line_start(const char *p) const {
+    while (p > map_ && (p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\r')) p--;
+    return p == map_ || p[-1] == '\n';
+}
+
+void puzzle_stream::skip_space() {
+    while (pos_ < end_) {
+        char ch = *pos_;
+        if (ch == '\n') {
+            line_++;
+            pos_++;
+        } else if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f') {
+            pos_++;
+        } else if (ch == '#' && at_line_start(pos_)) {
+            while (pos_ < end_ && *pos_ != '\n') pos_++;
+        } else {
+            break;
+        }
+    }
+}
+
+void puzzle_stream::skip_line() {
+    while (pos_ < end_ && *pos_ != '\n') pos_++;
+}
+
+void puzzle_stream::skip_board(std::size_t last_line) {
+    skip_line();
+    while (pos_ < end_ && line_ < last_line) {
+        pos_++;
+        line_++;
+        const char *p = pos_;
+        while (p < end_ && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        if (p >= end_ || *p == '\n') break;
+        skip_line();
+    }
+}
+
+const char *puzzle_stream::token_end() const {
+    const char *p = pos_;
+    while (p < end_ && !std::isspace(static_cast<unsigned char>(*p))) p++;
+    return p;
+}
+
+bool puzzle_stream::read_int(int &value) {
+    skip_space();
+    auto [ptr, ec] = std::from_chars(pos_, end_, value);
+    // Число має закінчуватися пробілом або кінцем файлу, інакше це інше слово ("3x", "12a")
+    if (ec != std::errc() || (ptr < end_ && !std::isspace(static_cast<unsigned char>(*ptr)))) return false;
+    pos_ = ptr;
+    return true;
+}
+
+bool puzzle_stream::next(entry &out) {
+    skip_space();
+    if (pos_ >= end_) return false;
+
+    out.index = index_++;
+    out.line = line_;
+    out.error.clear();
+
+    std::string_view token(pos_, token_end() - pos_);
+    if (token.find("nurikabe/") != std::string_view::npos) {
+        parse_url(out, pos_ + token.size());
+    } else if (std::isdigit(static_cast<unsigned char>(token[0])) && token.find('x') != std::string_view::npos &&
+               token.find(':') != std::string_view::npos) {
+        parse_compact(out, pos_ + token.size());
+    } else {
+        parse_plain(out);
+    }
+    if (out.ok() && check_clues_) out.error = grid_reader::validate(out.data);
+    return true;
+}
+
+// Максимальна кількість клітинок однієї задачі - захист від зіпсованих розмірів
+static constexpr long long MAX_STREAM_CELLS = 1 << 24;
+
+static bool set_size(grid_data &data, int rows, int cols) {
+    if (rows <= 0 || cols <= 0 || static_cast<long long>(rows) * cols > MAX_STREAM_CELLS) return false;
+    data.rows = rows;
+    data.cols = cols;
+    data.grid.assign(rows, std::vector<int>(cols, 0));
+    return true;
+}
+
+void puzzle_stream::parse_plain(entry &out) {
+    int rows, cols;
+    if (!read_int(rows) || !read_int(cols) || !set_size(out.data, rows, cols)) {
+        out.error = "невірний формат розмірів";
+        skip_line();
+        return;
+    }
+    // Рядки сітки йдуть після рядка розмірів: після помилки решта сітки не повинна читатися як нові задачі
+    std::size_t last_line = line_ + rows;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (!read_int(out.data.grid[r][c])) {
+                out.error = pos_ < end_ ? "очікувалося ціле число в рядку " + std::to_string(line_) : "недостатньо даних";
+                skip_board(last_line);
+                return;
+            }
+        }
+    }
+}
+
+void puzzle_stream::parse_url(entry &out, const char *tok_end) {
+    // ...?nurikabe/<cols>/<rows>/<дані>
+    std::string_view token(pos_, tok_end - pos_);
+    pos_ = tok_end;
+    std::size_t at = token.find("nurikabe/") + 9;
+    const char *p = token.data() + at, *end = token.data() + token.size();
+
+    int cols = 0, rows = 0;
+    auto r1 = std::from_chars(p, end, cols);
+    if (r1.ec != std::errc() || r1.ptr == end || *r1.ptr != '/') {
+        out.error = "невірні розміри в посиланні";
+        return;
+    }
+    auto r2 = std::from_chars(r1.ptr + 1, end, rows);
+    if (r2.ec != std::errc() || r2.ptr == end || *r2.ptr != '/' || !set_size(out.data, rows, cols)) {
+        out.error = "невірні розміри в посиланні";
+        return;
+    }
+    p = r2.ptr + 1;
+
+    // number16: 0-f - число, "-xx" / "+xxx" / "=xxx" / "%xxx" - довші числа, g-z - пропуск 1..20 клітинок
+    auto hex = [&](int digits, int &value) {
+        if (end - p < digits) return false;
+        auto res = std::from_chars(p, p + digits, value, 16);
+        if (res.ec != std::errc() || res.ptr != p + digits) return false;
+        p += digits;
+        return true;
+    };
+    const long long cells = static_cast<long long>(rows) * cols;
+    long long i = 0;
+    while (p < end && *p != '/' && i < cells) {
+        char ch = *p++;
+        int value = 0;
+        if ((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f')) {
+            value = ch <= '9' ? ch - '0' : ch - 'a' + 10;
+        } else if (ch == '-' || ch == '+' || ch == '=' || ch == '%') {
+            if (!hex(ch == '-' ? 2 : 3, value)) {
+                out.error = "обірване число в посиланні";
+                return;
+            }
+            value += ch == '=' ? 4096 : ch == '%' ? 8192 : 0;
+        } else if (ch == '.') {
+            out.error = "підказки '?' не підтримуються";
+            return;
+        } else if (ch >= 'g' && ch <= 'z') {
+            i += ch - 'f';
+            continue;
+        } else {
+            out.error = std::string("невідомий символ '") + ch + "' у посиланні";
+            return;
+        }
+        if (value == 0) {
+            out.error = "нульова підказка в посиланні";
+            return;
+        }
+        out.data.grid[i / cols][i % cols] = value;
+        i++;
+    }
+    if (p < end && *p != '/') out.error = "зайві дані в посиланні";
+}
+
+void puzzle_stream::parse_compact(entry &out, const char *tok_end) {
+    // <cols>x<rows>:<клітинки>
+    const char *p = pos_;
+    pos_ = tok_end;
+    int cols = 0, rows = 0;
+    auto r1 = std::from_chars(p, tok_end, cols);
+    if (r1.ec != std::errc() || r1.ptr == tok_end || *r1.ptr != 'x') {
+        out.error = "невірні розміри в рядковому записі";
+        return;
+    }
+    auto r2 = std::from_chars(r1.ptr + 1, tok_end, rows);
+    if (r2.ec != std::errc() || r2.ptr == tok_end || *r2.ptr != ':' || !set_size(out.data, rows, cols)) {
+        out.error = "невірні розміри в рядковому записі";
+        return;
+    }
+    p = r2.ptr + 1;
+    if (tok_end - p != static_cast<long long>(rows) * cols) {
+        out.error = "кількість клітинок у рядковому записі не відповідає розмірам";
+        return;
+    }
+    for (int i = 0; i < rows * cols; ++i, ++p) {
+        char ch = static_cast<char>(std::tolower(static_cast<unsigned char>(*p)));
+        int value;
+        if (ch == '.' || ch == '0') value = 0;
+        else if (ch >= '1' && ch <= '9') value = ch - '0';
+        else if (ch >= 'a' && ch <= 'z') value = ch - 'a' + 10;
+        else {
+            out.error = std::string("невідомий символ '") + *p + "' у рядковому записі";
+            return;
+        }
+        out.data.grid[i / cols][i % cols] = value;
+    }
+}
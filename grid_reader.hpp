@@ -4,6 +4,7 @@
 #include <string>
 #include <iostream>
 #include <stdexcept>
+#include <cstddef>
 
 // Структура для зберігання розмірів і значень сітки
 struct grid_data {
@@ -25,4 +26,83 @@ public:
         У разі помилки відкриття або формату кидає std::runtime_error
     */
     static grid_data from_file(const std::string &filepath);
+
+    /*
+        Зчитування сітки у форматі файлу (розміри, потім значення) з довільного потоку
+        У разі помилки формату кидає std::runtime_error
+    */
+    static grid_data from_stream(std::istream &in);
+
+    /*
+        Перевірка підказок, як у from_console: значення від 0 до rows*cols, жодних сусідніх підказок,
+        парна кількість підказок і сума не більша за кількість клітинок.
+        Повертає опис першої помилки або порожній рядок
+    */
+    static std::string validate(const grid_data &data);
+};
+
+/*
+    Потоковий розбір файлу з багатьма задачами. Файл відображається в пам'ять, числа читаються std::from_chars.
+    Кожна задача може бути записана в одному з форматів (формат визначається за першим словом):
+      звичайний     "rows cols", далі rows*cols чисел (як у input.txt)
+      посилання     https://puzz.link/p?nurikabe/<cols>/<rows>/<дані> - підказки в кодуванні number16
+      рядок         <cols>x<rows>:<клітинки> - по символу на клітинку: '.' або '0' - порожня,
+                    '1'-'9' і 'a'-'z' - підказки 1..35 (цифри за основою 36)
+    Рядки, що починаються з '#' (після пробілів), - коментарі; '#' посеред рядка не є коментарем. Помилка в одній задачі не зупиняє розбір решти
+*/
+class puzzle_stream {
+public:
+    struct entry {
+        std::size_t index = 0;      // порядковий номер задачі у файлі (з 0)
+        std::size_t line = 0;       // рядок, з якого почалася задача (з 1)
+        grid_data data{};
+        std::string error;          // порожній, якщо задачу прочитано і перевірено
+
+        bool ok() const { return error.empty(); }
+    };
+
+    /*
+        Відкриває файл, у разі помилки кидає std::runtime_error.
+        check_clues = false вимикає перевірку підказок (для файлів з рішеннями, де є -1 і -2)
+    */
+    explicit puzzle_stream(const std::string &path, bool check_clues = true);
+    ~puzzle_stream();
+
+    puzzle_stream(const puzzle_stream &) = delete;
+    puzzle_stream &operator=(const puzzle_stream &) = delete;
+
+    // Читає наступну задачу; false - кінець файлу
+    bool next(entry &out);
+
+    // Розмір файлу в байтах
+    std::size_t size() const { return size_; }
+
+private:
+    int fd_ = -1;
+    char *map_ = nullptr;
+    std::size_t size_ = 0;
+    const char *pos_ = nullptr;
+    const char *end_ = nullptr;
+    std::size_t line_ = 1;
+    std::size_t index_ = 0;
+    bool check_clues_;
+
+    // Чи стоять перед p у його рядку лише пробіли
+    bool at_line_start(const char *p) const;
+    /*
+        Пропускає пробіли, переведення рядків і коментарі. '#' починає коментар лише на початку рядка,
+        посеред сітки це помилка задачі, а не тихо відкинутий залишок рядка
+    */
+    void skip_space();
+    // Пропускає залишок поточного рядка (відновлення після помилки)
+    void skip_line();
+    // Пропускає решту задачі до кінця рядка last_line або до порожнього рядка (відновлення після помилки в сітці)
+    void skip_board(std::size_t last_line);
+    // Межа поточного слова
+    const char *token_end() const;
+    bool read_int(int &value);
+
+    void parse_plain(entry &out);
+    void parse_url(entry &out, const char *tok_end);
+    void parse_compact(entry &out, const char *tok_end);
 };
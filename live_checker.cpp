@@ -0,0 +1,323 @@
+#include "live_checker.hpp"
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+
+namespace {
+std::string where(int r, int c) {
+    return " (рядок " + std::to_string(r + 1) + ", стовпець " + std::to_string(c + 1) + ")";
+}
+}
+
+live_checker::live_checker(const grid &puzzle)
+    : rows_(static_cast<int>(puzzle.size())),
+      cols_(rows_ ? static_cast<int>(puzzle[0].size()) : 0),
+      state_(rows_ * cols_, EMPTY),
+      label_(rows_ * cols_, -1),
+      pos_(rows_ * cols_, 0),
+      window_(rows_ > 1 && cols_ > 1 ? (rows_ - 1) * (cols_ - 1) : 0, 0),
+      mark_(rows_ * cols_, 0),
+      empty_(rows_ * cols_)
+{
+    // Підказки - білі клітинки з самого початку, кожна з них - окрема компонента
+    for (int r = 0; r < rows_; ++r)
+        for (int c = 0; c < cols_; ++c)
+            if (puzzle[r][c] > 0) {
+                state_[r * cols_ + c] = puzzle[r][c];
+                add_cell(r * cols_ + c);
+            }
+}
+
+std::vector<live_checker::violation> live_checker::set(int r, int c, int state) {
+    if (out_of_bounds(r, c)) {
+        throw std::runtime_error("Клітинка" + where(r, c) + " поза межами сітки");
+    }
+    if (state != BLACK && state != FILLED && state != EMPTY) {
+        throw std::runtime_error("Недопустиме значення " + std::to_string(state));
+    }
+    int id = r * cols_ + c;
+    if (state_[id] > 0) {
+        throw std::runtime_error("Підказку" + where(r, c) + " змінювати не можна");
+    }
+    history_.push_back(id);
+    history_.push_back(state_[id]);
+    return apply(id, state);
+}
+
+std::vector<live_checker::violation> live_checker::undo() {
+    if (history_.empty()) return {};
+    int previous = history_.back();
+    history_.pop_back();
+    int id = history_.back();
+    history_.pop_back();
+    return apply(id, previous);
+}
+
+live_checker::summary live_checker::status() const {
+    summary s;
+    s.empty = empty_;
+    s.pools = pools_;
+    s.black_components = black_comps_;
+    s.islands = islands_;
+    s.exact_islands = exact_;
+    s.solved = empty_ == 0 && pools_ == 0 && black_comps_ <= 1 && islands_ == exact_;
+    return s;
+}
+
+std::vector<live_checker::violation> live_checker::apply(int id, int state) {
+    if (state_[id] != state) {
+        // Зміна кольору - це очищення клітинки і нове фарбування
+        if (state_[id] != EMPTY) remove_cell(id);
+        if (state != EMPTY) {
+            state_[id] = state;
+            add_cell(id);
+        }
+    }
+
+    // Порушення зачепленої ділянки: вікна 2x2 з цією клітинкою і компоненти клітинки та сусідів
+    std::vector<violation> out;
+    int r = id / cols_, c = id % cols_;
+    for (int wr = r - 1; wr <= r; ++wr)
+        for (int wc = c - 1; wc <= c; ++wc)
+            if (wr >= 0 && wc >= 0 && wr + 1 < rows_ && wc + 1 < cols_ && window_[wr * (cols_ - 1) + wc] == 4)
+                out.push_back({violation::black_2x2, cell(wr, wc), "знайдено 2×2 чорний блок у клітині" + where(wr, wc)});
+
+    int seen[5], n = 0;
+    auto visit = [&](int cid) {
+        int k = label_[cid];
+        if (k < 0) return;
+        for (int i = 0; i < n; ++i)
+            if (seen[i] == k) return;
+        seen[n++] = k;
+        collect(k, cid, out);
+    };
+    visit(id);
+    for (int d = 0; d < 4; ++d) {
+        int nr = r + DR_[d], nc = c + DC_[d];
+        if (!out_of_bounds(nr, nc)) visit(nr * cols_ + nc);
+    }
+    return out;
+}
+
+void live_checker::collect(int k, int near, std::vector<violation> &out) const {
+    const component &comp = comps_[k];
+    int size = static_cast<int>(comp.cells.size());
+    cell loc(near / cols_, near % cols_);
+    if (comp.black) {
+        // Чорна частина без порожніх сусідів уже ніколи не з'єднається з рештою
+        if (black_comps_ > 1 && comp.liberties == 0) {
+            out.push_back({violation::black_split, loc,
+                           "чорна частина з " + std::to_string(size) + " клітинок відрізана від решти" + where(loc.row, loc.col)});
+        }
+        return;
+    }
+    if (comp.clues > 2) {
+        out.push_back({violation::too_many_clues, loc, "острів має більше 2 підказки" + where(loc.row, loc.col)});
+    } else if (comp.clues == 2 && size > comp.clue_sum) {
+        out.push_back({violation::wrong_size, loc,
+                       "площа острова (" + std::to_string(size) + ") перевищує суму підказок: " +
+                       std::to_string(comp.clue_sum) + where(loc.row, loc.col)});
+    } else if (comp.liberties == 0 && comp.clues < 2) {
+        out.push_back({violation::too_few_clues, loc, "острів має менше ніж 2 підказки" + where(loc.row, loc.col)});
+    } else if (comp.liberties == 0 && size != comp.clue_sum) {
+        out.push_back({violation::wrong_size, loc,
+                       "площа острова (" + std::to_string(size) + ") не дорівнює сумі підказок: " +
+                       std::to_string(comp.clue_sum) + where(loc.row, loc.col)});
+    }
+}
+
+int live_checker::empty_neighbours(int id) const {
+    int r = id / cols_, c = id % cols_, count = 0;
+    for (int d = 0; d < 4; ++d) {
+        int nr = r + DR_[d], nc = c + DC_[d];
+        if (!out_of_bounds(nr, nc) && state_[nr * cols_ + nc] == EMPTY) count++;
+    }
+    return count;
+}
+
+void live_checker::update_windows(int id, int delta) {
+    int r = id / cols_, c = id % cols_;
+    for (int wr = r - 1; wr <= r; ++wr)
+        for (int wc = c - 1; wc <= c; ++wc) {
+            if (wr < 0 || wc < 0 || wr + 1 >= rows_ || wc + 1 >= cols_) continue;
+            unsigned char &w = window_[wr * (cols_ - 1) + wc];
+            if (w == 4) pools_--;
+            w = static_cast<unsigned char>(w + delta);
+            if (w == 4) pools_++;
+        }
+}
+
+// Клітинка id щойно стала чорною або білою (до цього була порожньою)
+void live_checker::add_cell(int id) {
+    int r = id / cols_, c = id % cols_;
+    bool black = state_[id] == BLACK;
+    empty_--;
+    if (black) update_windows(id, +1);
+
+    // Сусідні компоненти втрачають свободу в цій клітинці
+    for (int d = 0; d < 4; ++d) {
+        int nr = r + DR_[d], nc = c + DC_[d];
+        if (!out_of_bounds(nr, nc) && label_[nr * cols_ + nc] >= 0) comps_[label_[nr * cols_ + nc]].liberties--;
+    }
+
+    int k = new_component(black);
+    attach(k, id);
+    comps_[k].liberties = empty_neighbours(id);
+
+    // Зливаємо з сусідніми компонентами того ж кольору
+    for (int d = 0; d < 4; ++d) {
+        int nr = r + DR_[d], nc = c + DC_[d];
+        if (out_of_bounds(nr, nc)) continue;
+        int nb = nr * cols_ + nc;
+        if (label_[nb] >= 0 && label_[nb] != label_[id] && comps_[label_[nb]].black == black) merge(label_[id], label_[nb]);
+    }
+    refresh(label_[id]);
+}
+
+// Клітинка id очищається
+void live_checker::remove_cell(int id) {
+    int r = id / cols_, c = id % cols_;
+    int k = label_[id];
+    bool black = comps_[k].black;
+    comps_[k].liberties -= empty_neighbours(id);
+    detach(k, id);
+    if (black) update_windows(id, -1);
+    state_[id] = EMPTY;
+    empty_++;
+
+    // Тепер клітинка - свобода для всіх сусідніх компонент; збираємо сусідів з колишньої компоненти
+    std::vector<int> same;
+    for (int d = 0; d < 4; ++d) {
+        int nr = r + DR_[d], nc = c + DC_[d];
+        if (out_of_bounds(nr, nc)) continue;
+        int nb = nr * cols_ + nc;
+        if (label_[nb] < 0) continue;
+        comps_[label_[nb]].liberties++;
+        if (label_[nb] == k) same.push_back(nb);
+    }
+
+    if (comps_[k].cells.empty()) {
+        release_component(k);
+        return;
+    }
+    // Видалення клітинки з одним сусідом у компоненті не може її розірвати
+    if (same.size() >= 2) split(k, same[0], std::vector<int>(same.begin() + 1, same.end()));
+    refresh(k);
+}
+
+void live_checker::split(int k, int start, const std::vector<int> &others) {
+    if (++mark_epoch_ == 0) {
+        std::fill(mark_.begin(), mark_.end(), 0);
+        mark_epoch_ = 1;
+    }
+    std::vector<int> queue;
+    auto bfs = [&](int from) {
+        queue.clear();
+        queue.push_back(from);
+        mark_[from] = mark_epoch_;
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            int u = queue[i], r = u / cols_, c = u % cols_;
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DR_[d], nc = c + DC_[d];
+                if (out_of_bounds(nr, nc)) continue;
+                int nb = nr * cols_ + nc;
+                if (label_[nb] == k && mark_[nb] != mark_epoch_) {
+                    mark_[nb] = mark_epoch_;
+                    queue.push_back(nb);
+                }
+            }
+        }
+    };
+
+    bfs(start);
+    // Кожен недосяжний сусід - початок нової компоненти
+    for (int o : others) {
+        if (mark_[o] == mark_epoch_) continue;
+        bfs(o);
+        int n = new_component(comps_[k].black);
+        for (int u : queue) {
+            int lib = empty_neighbours(u);
+            detach(k, u);
+            attach(n, u);
+            comps_[k].liberties -= lib;
+            comps_[n].liberties += lib;
+        }
+        refresh(n);
+    }
+}
+
+int live_checker::new_component(bool black) {
+    int k;
+    if (!free_ids_.empty()) {
+        k = free_ids_.back();
+        free_ids_.pop_back();
+    } else {
+        k = static_cast<int>(comps_.size());
+        comps_.emplace_back();
+    }
+    component &comp = comps_[k];
+    comp.cells.clear();
+    comp.clues = comp.clue_sum = comp.liberties = 0;
+    comp.black = black;
+    comp.exact = false;
+    if (black) black_comps_++;
+    else islands_++;
+    return k;
+}
+
+void live_checker::release_component(int k) {
+    component &comp = comps_[k];
+    if (comp.exact) exact_--;
+    comp.exact = false;
+    if (comp.black) black_comps_--;
+    else islands_--;
+    comp.cells.clear();
+    free_ids_.push_back(k);
+}
+
+void live_checker::attach(int k, int id) {
+    component &comp = comps_[k];
+    label_[id] = k;
+    pos_[id] = static_cast<int>(comp.cells.size());
+    comp.cells.push_back(id);
+    if (state_[id] > 0) {
+        comp.clues++;
+        comp.clue_sum += state_[id];
+    }
+}
+
+void live_checker::detach(int k, int id) {
+    component &comp = comps_[k];
+    int last = comp.cells.back();
+    comp.cells[pos_[id]] = last;
+    pos_[last] = pos_[id];
+    comp.cells.pop_back();
+    if (state_[id] > 0) {
+        comp.clues--;
+        comp.clue_sum -= state_[id];
+    }
+    label_[id] = -1;
+}
+
+// Менша компонента переписується в більшу; номер результату - label_ будь-якої з їхніх клітинок
+void live_checker::merge(int a, int b) {
+    if (comps_[a].cells.size() < comps_[b].cells.size()) std::swap(a, b);
+    component &big = comps_[a];
+    component &small = comps_[b];
+    for (int id : small.cells) {
+        label_[id] = a;
+        pos_[id] = static_cast<int>(big.cells.size());
+        big.cells.push_back(id);
+    }
+    big.clues += small.clues;
+    big.clue_sum += small.clue_sum;
+    big.liberties += small.liberties;
+    release_component(b);
+}
+
+void live_checker::refresh(int k) {
+    component &comp = comps_[k];
+    bool exact = !comp.black && comp.clues == 2 && static_cast<int>(comp.cells.size()) == comp.clue_sum;
+    if (exact != comp.exact) exact_ += exact ? 1 : -1;
+    comp.exact = exact;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include "cell.hpp"
+#include "user_solution_checker.hpp"
+
+/*
+    Інкрементальна перевірка рішення під час редагування: гравець змінює по одній клітинці
+    (чорна, заповнена, порожня), а перевірка оновлює лише зачеплену частину стану.
+
+    Стан, який підтримується:
+      - кількість чорних клітинок у кожному вікні 2x2 і загальна кількість чорних блоків 2x2;
+      - мітки зв'язних компонент білих (острови) і чорних клітинок з розміром, кількістю і сумою підказок
+        та кількістю суміжних порожніх клітинок ("свобод");
+      - злиття компонент - меншу переписуємо в більшу, розщеплення після очищення клітинки - BFS по компоненті.
+    Порушення повідомляються лише остаточні: острів без свобод, який уже не можна виправити добудовою,
+    острів з трьома підказками, чорна частина, замкнена білими клітинками, тощо.
+    Кожна зміна записується в журнал і може бути скасована
+*/
+class live_checker {
+public:
+    using grid = std::vector<std::vector<int>>;
+    using violation = user_solution_checker::violation;
+
+    // Значення клітинок такі ж, як у розв'язувачі
+    static constexpr int EMPTY = 0, BLACK = -1, FILLED = -2;
+
+    struct summary {
+        int empty = 0;              // кількість порожніх клітинок
+        int pools = 0;              // кількість чорних блоків 2x2
+        int black_components = 0;   // кількість чорних компонент
+        int islands = 0;            // кількість білих компонент
+        int exact_islands = 0;      // острови з двома підказками і площею, що дорівнює їхній сумі
+        bool solved = false;
+    };
+
+    // Починає з порожнього поля задачі puzzle (підказки - білі клітинки, решта порожні)
+    explicit live_checker(const grid &puzzle);
+
+    /*
+        Змінює клітинку на BLACK, FILLED або EMPTY і повертає порушення, що стосуються зміненої ділянки:
+        блоки 2x2 з цією клітинкою і компоненти клітинки та її сусідів.
+        Зміна підказки або невідоме значення кидають std::runtime_error
+    */
+    std::vector<violation> set(int r, int c, int state);
+
+    // Скасовує останню зміну і повертає порушення зачепленої ділянки; false в can_undo - журнал порожній
+    std::vector<violation> undo();
+    bool can_undo() const { return !history_.empty(); }
+
+    int at(int r, int c) const { return state_[r * cols_ + c]; }
+
+    summary status() const;
+
+private:
+    struct component {
+        std::vector<int> cells;
+        int clues = 0;
+        int clue_sum = 0;
+        int liberties = 0;      // кількість пар (клітинка компоненти, порожній сусід)
+        bool black = false;
+        bool exact = false;
+    };
+
+    int rows_, cols_;
+    std::vector<int> state_;            // значення клітинок
+    std::vector<int> label_;            // номер компоненти клітинки або -1 для порожньої
+    std::vector<int> pos_;              // позиція клітинки у списку cells її компоненти
+    std::vector<component> comps_;
+    std::vector<int> free_ids_;         // номери вільних компонент для повторного використання
+    std::vector<unsigned char> window_; // кількість чорних клітинок у вікні 2x2 з лівим верхнім кутом (r, c)
+    std::vector<int> history_;          // журнал змін: пари (клітинка, попереднє значення)
+    std::vector<int> mark_;             // позначки для BFS при розщепленні
+    int mark_epoch_ = 0;
+
+    int empty_ = 0, pools_ = 0, black_comps_ = 0, islands_ = 0, exact_ = 0;
+
+    static constexpr int DR_[4] = {-1, 1, 0, 0};
+    static constexpr int DC_[4] = {0, 0, -1, 1};
+
+    bool out_of_bounds(int r, int c) const { return r < 0 || c < 0 || r >= rows_ || c >= cols_; }
+
+    // Застосовує зміну без запису в журнал
+    std::vector<violation> apply(int id, int state);
+
+    void add_cell(int id);
+    void remove_cell(int id);
+    void update_windows(int id, int delta);
+
+    int new_component(bool black);
+    void release_component(int k);
+    void attach(int k, int id);
+    void detach(int k, int id);
+    void merge(int a, int b);
+    // Відокремлює від k частини, не зв'язані з клітинкою start, у нові компоненти
+    void split(int k, int start, const std::vector<int> &others);
+    // Перераховує ознаку "точного" острова і лічильник таких островів
+    void refresh(int k);
+
+    int empty_neighbours(int id) const;
+    void collect(int k, int near, std::vector<violation> &out) const;
+};
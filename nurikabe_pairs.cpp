@@ -2,54 +2,361 @@
 #include <iomanip>
 #include <stdexcept>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <optional>
 #include "grid_reader.hpp"
 #include "nurikabe_solver.hpp"
 #include "user_solution_checker.hpp"
+#include "solver_service.hpp"
+#include "puzzle_corpus.hpp"
+#include "live_checker.hpp"
+#include "step_renderer.hpp"
+#include "search_trace.hpp"
 
 using grid = std::vector<std::vector<int>>;
 
-// Вивід довільної сітки у консолі
-void display(const grid &grid) {
-    int rows = grid.size();
-    int cols = rows ? grid[0].size() : 0;
-
-    const std::string horizontal = "───";
-    const std::string corner_tl = "┌", corner_tr = "┐";
-    const std::string corner_bl = "└", corner_br = "┘";
-    const std::string vertical = "│";
-
-    // Верхня межа
-    std::cout << corner_tl;
-    for (int c = 0; c < cols; ++c)
-        std::cout << horizontal;
-    std::cout << corner_tr << "\n";
-
-    // Вміст рядків
-    for (int r = 0; r < rows; ++r) {
-        std::cout << vertical;
-        for (int c = 0; c < cols; ++c) {
-            int v = grid[r][c];
-            if (v == nurikabe_solver::FILLED)
-                std::cout << " #";
-            else if (v == nurikabe_solver::BLACK)
-                std::cout << " X";
-            else
-                std::cout << std::setw(2) << v;
-
-            std::cout << " ";
-        }
-        std::cout << vertical << "\n";
+// Підказка щодо режимів командного рядка
+void usage(const char *program) {
+    std::cerr << "Використання:\n"
+              << "  " << program << "                                   інтерактивне меню\n"
+              << "  " << program << " --serve <адреса> [потоки] [черга] [файл_кешу]   запустити сервіс розв'язання\n"
+              << "  " << program << " --solve <файл> [search|dlx|sat] [формат] [all|final|quiet]\n"
+              << "  " << program << " --request <адреса> <файл> [search|dlx|sat] [deadline_ms] [формат] [all|final|quiet]\n"
+              << "  " << program << " --convert <текст> <корпус> [search|dlx|sat]   текст -> двійковий корпус (з розв'язками)\n"
+              << "  " << program << " --validate <задачі> <рішення> [потоки]   пакетна перевірка рішень\n"
+              << "  " << program << " --live <задача>   покрокова перевірка: рядки \"r c x|#|.\", u - скасувати\n"
+              << "  " << program << " --hint <стан> [бюджет_мс]   наступний крок для частково розв'язаної задачі\n"
+              << "  " << program << " --trace <файл> [префікс] [розмір_кільця]   запис дерева пошуку (префікс.json, префікс.bin)\n"
+              << "  " << program << " --trace-summary <префікс.bin> [top]   найбільші піддерева і пари з найбільшою кількістю відкатів\n"
+              << "  " << program << " --parse-bench <текст> [повтори]   швидкість розбору текстових задач\n"
+              << "  " << program << " --batch <корпус> [search|dlx|sat] [від] [до] [потоки]\n"
+              << "  " << program << " --stats <адреса>\n"
+              << "  " << program << " --stop <адреса>\n"
+              << "Формати кроків: box, ascii, json, delta, plain\n"
+              << "Адреса з цифр - TCP-порт на 127.0.0.1, інакше - шлях до Unix-сокета\n";
+}
+
+// Повідомлення про задачу, яку не вдалося прочитати
+void report_entry(const std::string &path, const puzzle_stream::entry &e) {
+    std::cerr << path << ":" << e.line << ": задача " << e.index << ": " << e.error << "\n";
+}
+
+/*
+    Перетворює текстовий файл з кількома задачами (формати puzzle_stream) на двійковий корпус.
+    Некоректні задачі пропускаються з повідомленням. Якщо вказано алгоритм, кожна задача
+    розв'язується і розв'язок зберігається в корпусі
+*/
+int run_convert(const std::string &text_path, const std::string &corpus_path, const std::string &engine) {
+    // Невідома назва алгоритму - помилка всієї команди, а не задача без розв'язку
+    std::optional<nurikabe_solver::engine> mode;
+    if (!engine.empty()) mode = nurikabe_solver::parse_engine(engine);
+    puzzle_stream in(text_path);
+    nurikabe_solver solver;
+    corpus_writer writer(corpus_path);
+    int unsolved = 0, rejected = 0;
+    puzzle_stream::entry e;
+    while (in.next(e)) {
+        if (!e.ok()) {
+            report_entry(text_path, e);
+            rejected++;
+            continue;
+        }
+        if (!mode) {
+            writer.add(e.data.grid);
+            continue;
+        }
+        try {
+            auto steps = solver.solve(e.data.grid, *mode);
+            writer.add(e.data.grid, &steps.back());
+        } catch (const std::runtime_error &) {
+            writer.add(e.data.grid);
+            unsolved++;
+        }
     }
+    writer.finish();
+    std::cout << "Записано задач: " << writer.size() << ", відхилено: " << rejected;
+    if (!engine.empty()) std::cout << ", без розв'язку: " << unsolved;
+    std::cout << "\n";
+    return rejected ? 1 : 0;
+}
 
-    // Нижня межа
-    std::cout << corner_bl;
-    for (int c = 0; c < cols; ++c)
-        std::cout << horizontal;
-    std::cout << corner_br << "\n";
+// Вимірює швидкість розбору текстового файлу з задачами (repeat проходів)
+int run_parse_bench(const std::string &path, int repeat) {
+    long long boards = 0, errors = 0;
+    std::size_t bytes = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+        puzzle_stream in(path);
+        puzzle_stream::entry e;
+        while (in.next(e)) {
+            boards++;
+            if (!e.ok()) {
+                errors++;
+                if (i == 0) report_entry(path, e);
+            }
+        }
+        bytes += in.size();
+    }
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+    double sec = std::max(duration.count(), 1e-9);
+    std::cout << "Задач: " << boards << ", з помилками: " << errors << "\n"
+              << "Час: " << std::fixed << std::setprecision(3) << duration.count() << " секунд, "
+              << std::setprecision(0) << boards / sec << " задач/с, "
+              << std::setprecision(1) << bytes / sec / (1 << 20) << " МБ/с\n";
+    return 0;
 }
 
-int main() {
+/*
+    Розв'язує задачі корпусу з номерами [from, to) кількома потоками; кожен потік бере суцільний діапазон.
+    Якщо в корпусі є розв'язок, острови знайденого розв'язку порівнюються з ним
+*/
+int run_batch(const std::string &corpus_path, const std::string &engine, std::size_t from, std::size_t to, int threads) {
+    puzzle_corpus corpus(corpus_path);
+    to = std::min(to, corpus.size());
+    if (from > to) from = to;
+    if (threads < 1) threads = 1;
+    nurikabe_solver::engine mode = nurikabe_solver::parse_engine(engine);
+
+    std::atomic<long long> solved{0}, failed{0}, mismatched{0};
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> pool;
+    std::size_t chunk = (to - from + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        std::size_t lo = std::min(to, from + t * chunk), hi = std::min(to, lo + chunk);
+        pool.emplace_back([&, lo, hi] {
+            nurikabe_solver solver;
+            for (std::size_t i = lo; i < hi; ++i) {
+                try {
+                    // Пошкоджений запис рахується як задача без розв'язку і не зупиняє решту пакета
+                    puzzle_corpus::board_view board = corpus.board(i);
+                    grid result = solver.solve(board.to_grid(), mode).back();
+                    solved++;
+                    if (!board.has_solution()) continue;
+                    for (int r = 0; r < board.rows; ++r)
+                        for (int c = 0; c < board.cols; ++c)
+                            if ((result[r][c] != nurikabe_solver::BLACK) != (board.solution[r * board.cols + c] != 0)) {
+                                mismatched++;
+                                r = board.rows;
+                                break;
+                            }
+                } catch (const std::exception &) {
+                    // Виняток, що вийшов би з потоку, викликав би std::terminate для всього пакета
+                    failed++;
+                }
+            }
+        });
+    }
+    for (auto &t : pool) t.join();
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+    std::size_t total = to - from;
+    std::cout << "Задач: " << total << ", розв'язано: " << solved << ", без розв'язку: " << failed
+              << ", відмінних від збереженого розв'язку: " << mismatched << "\n"
+              << "Час: " << std::fixed << std::setprecision(2) << duration.count() << " секунд, "
+              << std::setprecision(1) << (duration.count() > 0 ? total / duration.count() : 0.0) << " задач/с\n";
+    return failed ? 1 : 0;
+}
+
+/*
+    Перевіряє файл рішень проти файлу задач (i-те рішення - для i-ї задачі) паралельно
+    і виводить усі порушення кожного неправильного рішення
+*/
+int run_validate(const std::string &puzzles_path, const std::string &solutions_path, int threads) {
+    std::vector<grid> puzzles, solutions;
+    puzzle_stream::entry e;
+    puzzle_stream pin(puzzles_path);
+    while (pin.next(e)) {
+        if (!e.ok()) throw std::runtime_error(puzzles_path + ":" + std::to_string(e.line) + ": " + e.error);
+        puzzles.push_back(std::move(e.data.grid));
+    }
+    puzzle_stream sin(solutions_path, false);
+    while (sin.next(e)) {
+        if (!e.ok()) throw std::runtime_error(solutions_path + ":" + std::to_string(e.line) + ": " + e.error);
+        solutions.push_back(std::move(e.data.grid));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto results = user_solution_checker::validate_batch(puzzles, solutions, threads);
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+    std::size_t wrong = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (results[i].empty()) continue;
+        wrong++;
+        std::cout << "Рішення " << i << ":\n";
+        for (const auto &v : results[i]) std::cout << "  " << v.reason << "\n";
+    }
+    std::cout << "Перевірено рішень: " << results.size() << ", неправильних: " << wrong << "\n"
+              << "Час: " << std::fixed << std::setprecision(3) << duration.count() << " секунд\n";
+    return wrong ? 1 : 0;
+}
+
+/*
+    Покрокова перевірка рішення: кожен рядок стандартного вводу - одна зміна клітинки
+    "рядок стовпець стан" (нумерація з 1, стан x - чорна, # - заповнена, . - порожня),
+    "u" скасовує останню зміну. Після кожної зміни друкуються порушення зачепленої ділянки
+*/
+int run_live(const std::string &puzzle_path) {
+    grid_data data = grid_reader::from_file(puzzle_path);
+    live_checker checker(data.grid);
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string first;
+        if (!(in >> first) || first[0] == '#') continue;
+
+        std::vector<live_checker::violation> found;
+        try {
+            if (first == "u") {
+                if (!checker.can_undo()) {
+                    std::cout << "Нічого скасовувати\n";
+                    continue;
+                }
+                found = checker.undo();
+            } else {
+                int r = std::stoi(first), c;
+                std::string state;
+                if (!(in >> c >> state) || state.size() != 1 || std::string("x#.").find(state[0]) == std::string::npos) {
+                    std::cout << "Невірна команда: " << line << "\n";
+                    continue;
+                }
+                int value = state[0] == 'x' ? live_checker::BLACK : state[0] == '#' ? live_checker::FILLED : live_checker::EMPTY;
+                found = checker.set(r - 1, c - 1, value);
+            }
+        } catch (const std::exception &e) {
+            std::cout << e.what() << "\n";
+            continue;
+        }
+
+        for (const auto &v : found) std::cout << "  " << v.reason << "\n";
+        live_checker::summary s = checker.status();
+        std::cout << "Порожніх: " << s.empty << ", блоків 2x2: " << s.pools << ", чорних частин: " << s.black_components
+                  << ", островів: " << s.exact_islands << "/" << s.islands << (s.solved ? ", розв'язано!" : "") << "\n";
+    }
+    return checker.status().solved ? 0 : 1;
+}
+
+// Підказка для часткового стану з файлу (-1 - чорна, -2 - заповнена клітинка острова)
+int run_hint(const std::string &path, int budget_ms) {
+    grid_data data = grid_reader::from_file(path);
+    nurikabe_solver solver;
+    nurikabe_solver::hint h = solver.next_hint(data.grid, std::chrono::milliseconds(budget_ms));
+    std::cout << h.reason << "\n";
+    for (const cell &c : h.cells) std::cout << "  рядок " << c.row + 1 << ", стовпець " << c.col + 1 << "\n";
+    return h.kind == nurikabe_solver::hint::contradiction ? 1 : 0;
+}
+
+// Розв'язує задачу перебором пар із записом дерева пошуку
+int run_trace(const std::string &path, const std::string &prefix, std::size_t ring_size) {
+    grid_data data = grid_reader::from_file(path);
+    search_trace trace(ring_size);
+    nurikabe_solver solver;
+    solver.attach_trace(&trace);
+    int rc = 0;
+    try {
+        solver.solve(data.grid);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << "\n";
+        rc = 1;
+    }
+    trace.write_chrome(prefix + ".json");
+    trace.write_binary(prefix + ".bin");
+    std::cout << "Записано подій: " << trace.events().size() << " у " << prefix << ".json і " << prefix << ".bin\n";
+    const candidate_cache::statistics &cs = solver.candidate_stats();
+    std::cout << "Кеш островів пар: влучань " << cs.hits << ", промахів " << cs.misses << ", застарілих " << cs.stale
+              << ", витіснено " << cs.evictions << "\n";
+    return rc;
+}
+
+// Режими роботи з сервісом розв'язання і корпусами задач
+int run_command(int argc, char *argv[]) {
+    std::string mode = argv[1];
+    try {
+        if (mode == "--serve" && argc >= 3) {
+            solver_service::options opt;
+            opt.address = argv[2];
+            if (argc >= 4) opt.workers = std::stoi(argv[3]);
+            if (argc >= 5) opt.queue_capacity = std::stoi(argv[4]);
+            if (argc >= 6) opt.cache_path = argv[5];
+            solver_service service(opt);
+            std::cout << "Сервіс слухає " << opt.address << " (потоків: " << opt.workers << ")\n";
+            service.run();
+            return 0;
+        }
+        if (mode == "--request" && argc >= 4) {
+            grid_data data = grid_reader::from_file(argv[3]);
+            std::string engine = argc >= 5 ? argv[4] : "search";
+            int deadline_ms = argc >= 6 ? std::stoi(argv[5]) : 0;
+            step_renderer::options opt;
+            if (argc >= 7) opt.fmt = step_renderer::parse_format(argv[6]);
+            if (argc >= 8) opt.level = step_renderer::parse_verbosity(argv[7]);
+            auto steps = service_client::solve(argv[2], data.grid, engine, deadline_ms);
+            step_renderer(opt).write_steps(std::cout, steps);
+            return 0;
+        }
+        if (mode == "--solve" && argc >= 3) {
+            grid_data data = grid_reader::from_file(argv[2]);
+            nurikabe_solver::engine engine = nurikabe_solver::parse_engine(argc >= 4 ? argv[3] : "search");
+            step_renderer::options opt;
+            if (argc >= 5) opt.fmt = step_renderer::parse_format(argv[4]);
+            if (argc >= 6) opt.level = step_renderer::parse_verbosity(argv[5]);
+            nurikabe_solver solver;
+            step_renderer(opt).write_steps(std::cout, solver.solve(data.grid, engine));
+            return 0;
+        }
+        if (mode == "--convert" && argc >= 4) {
+            return run_convert(argv[2], argv[3], argc >= 5 ? argv[4] : "");
+        }
+        if (mode == "--validate" && argc >= 4) {
+            return run_validate(argv[2], argv[3], argc >= 5 ? std::stoi(argv[4]) : 0);
+        }
+        if (mode == "--live" && argc >= 3) {
+            return run_live(argv[2]);
+        }
+        if (mode == "--hint" && argc >= 3) {
+            return run_hint(argv[2], argc >= 4 ? std::stoi(argv[3]) : 1000);
+        }
+        if (mode == "--trace" && argc >= 3) {
+            return run_trace(argv[2], argc >= 4 ? argv[3] : "trace", argc >= 5 ? std::stoull(argv[4]) : 1 << 20);
+        }
+        if (mode == "--trace-summary" && argc >= 3) {
+            std::cout << search_trace::summarize(argv[2], argc >= 4 ? std::stoi(argv[3]) : 10);
+            return 0;
+        }
+        if (mode == "--parse-bench" && argc >= 3) {
+            return run_parse_bench(argv[2], argc >= 4 ? std::stoi(argv[3]) : 1);
+        }
+        if (mode == "--batch" && argc >= 3) {
+            std::string engine = argc >= 4 ? argv[3] : "search";
+            std::size_t from = argc >= 5 ? std::stoull(argv[4]) : 0;
+            std::size_t to = argc >= 6 ? std::stoull(argv[5]) : static_cast<std::size_t>(-1);
+            int threads = argc >= 7 ? std::stoi(argv[6]) : static_cast<int>(std::thread::hardware_concurrency());
+            return run_batch(argv[2], engine, from, to, threads);
+        }
+        if (mode == "--stats" && argc >= 3) {
+            std::cout << service_client::stats(argv[2]);
+            return 0;
+        }
+        if (mode == "--stop" && argc >= 3) {
+            service_client::stop(argv[2]);
+            return 0;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    usage(argv[0]);
+    return 2;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) return run_command(argc, argv);
+
     nurikabe_solver solver;
+    step_renderer renderer;
 
     while (true) {
         std::cout << "\n=== Головне меню ===\n"
@@ -76,8 +383,7 @@ int main() {
             continue;
         }
 
-        std::cout << "\n--- Початкова сітка ---\n";
-        display(data.grid);
+        std::cout << "\n--- Початкова сітка ---\n" << renderer.render(data.grid);
 
         while (true) {
             std::cout << "\n--- Режим розв'язання ---\n"
@@ -93,18 +399,28 @@ int main() {
                 checker.input_solution_interactive(std::cin, std::cout);
 
             } else if (choice2 == 2) {
+                std::cout << "\n--- Алгоритм пошуку ---\n"
+                        << "1) Перебір пар за пріоритетом\n"
+                        << "2) Точне покриття (DLX)\n"
+                        << "3) SAT-кодування\n"
+                        << "\nВаш вибір: ";
+                int choice3;
+                if (!(std::cin >> choice3) || choice3 < 1 || choice3 > 3) {
+                    std::cerr << "Невірний пункт меню\n";
+                    continue;
+                }
+                const nurikabe_solver::engine engines[] = {
+                    nurikabe_solver::engine::search, nurikabe_solver::engine::dlx, nurikabe_solver::engine::sat
+                };
+                auto mode = engines[choice3 - 1];
                 try {
                     auto start = std::chrono::high_resolution_clock::now();
-                    auto steps = solver.solve(data.grid);
+                    auto steps = solver.solve(data.grid, mode);
                     auto end = std::chrono::high_resolution_clock::now();
                     std::chrono::duration<double> duration = end - start;
 
                     std::cout << "\n--- Покрокове рішення ---\n";
-                    for (size_t i = 0; i < steps.size(); ++i) {
-                        std::cout << "Крок " << (i+1) << " з " << steps.size() << ":\n";
-                        display(steps[i]);
-                        std::cout << "---\n";
-                    }
+                    renderer.write_steps(std::cout, steps);
 
                     std::cout << "Час розв'язання: " << std::fixed << std::setprecision(2) << duration.count() << " секунд\n";
                 } catch (const std::runtime_error &e) {
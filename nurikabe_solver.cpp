@@ -1,143 +1,503 @@
 #include "nurikabe_solver.hpp"
+#include "dlx_matrix.hpp"
+#include "sat_solver.hpp"
+#include "solution_cache.hpp"
 #include <unordered_map>
-#include <queue>
+#include <optional>
+#include <functional>
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <stdexcept>
 
 // Рекурсивний алгоритм пошуку
-std::vector<nurikabe_solver::grid> nurikabe_solver::solve(const grid initial) {
-    // Зберігаємо незмінну копію та ініціалізуємо робочу сітку
+std::vector<nurikabe_solver::grid> nurikabe_solver::solve(const grid initial, engine mode) {
+    /*
+        Зберігаємо незмінну копію та ініціалізуємо робочу сітку.
+        Буфери попереднього розв'язання не звільняються - присвоєння перевикористовує їхню пам'ять
+    */
     initial_grid_ = initial;
+    // Після перерваного розв'язання на стеку могли залишитися шляхи
+    while (!path_stack_.empty()) path_stack_.pop();
+    fixed_white_.clear();
+    trace_ring_ = trace_ ? &trace_->local() : nullptr;
     rows_ = static_cast<int>(initial.size());
     cols_ = rows_ ? static_cast<int>(initial[0].size()) : 0;
     grid_ = initial;
     used_.assign(rows_ * cols_, 0);
 
-    // Рекурсивний пошук
-    if (!solve_recurse()) {
-        // Повертаємо початковий стан глобальних полів
-        grid_.clear();
-        used_.clear();
-        rows_ = 0;
-        cols_ = 0;
-        initial_grid_.clear();
-        throw std::runtime_error("Рішення не знайдено");
-    }
+    // Задача (можливо, повернута чи віддзеркалена) вже розв'язувалася - відновлюємо кроки з кешу
+    std::vector<int> order;
+    if (cache_ && cache_->lookup(initial, order)) {
+        push_island_order(order);
+    } else {
+        pairs_.build(initial);
+        candidates_.reset(pairs_.edge_count());
 
-    grid_.clear();
-    used_.clear();
+        // Рекурсивний пошук обраним алгоритмом
+        bool found;
+        switch (mode) {
+            case engine::dlx: found = solve_dlx(); break;
+            case engine::sat: found = solve_sat(); break;
+            default:
+                local_exact_ = !has_black_2x2_block() && is_black_area_connected();
+                found = solve_recurse(0);
+                break;
+        }
+        if (!found) {
+            rows_ = 0;
+            cols_ = 0;
+            throw std::runtime_error("Рішення не знайдено");
+        }
+        if (cache_) cache_->store(initial, island_order());
+    }
 
     // Відновлюємо покроково рішення
     std::vector<nurikabe_solver::grid> res = recover_step_by_step();
-    // Повертаємо початковий стан глобальних полів
     rows_ = 0;
     cols_ = 0;
-    initial_grid_.clear();
 
     // Повертаємо покрокове відновлення
     return res;
 }
 
-bool nurikabe_solver::solve_recurse() {
-    // Скорочена назва для пари двох клітинок
-    using anchor = std::pair<cell, cell>;
-    // Дуже важлива частина програми - компаратор для пріоритезації пар з меншою кількістю можливих шляхів
-    auto cmp = [&](anchor const &p, anchor const &q) {
-        int sum_a = grid_[p.first.row][p.first.col] + grid_[p.second.row][p.second.col];
-        int sum_b = grid_[q.first.row][q.first.col] + grid_[q.second.row][q.second.col];
-        // Знаходиться різниця між загальною кількістю клітинок і мінімальною кількістю для з'єднання початку і кінця
-        int free_a = sum_a -  manhattan(p.first,p.second);
-        int free_b = sum_b - manhattan(q.first,q.second);
-        if (free_a != free_b) return free_a > free_b;
-        /*
-            Якщо кількість "вільних" клітинок рівна, в пріоритеті пара з більшою сумую загальних клітинок,
-            так як вона дозволить в майбутньому значно зменшити зону пошуку
-        */
-        return sum_a < sum_b;
-    };
-    // Пріоритетна черга для зберігання "найкращих" пар
-    std::priority_queue<anchor, std::vector<anchor>, decltype(cmp)> pq(cmp);
+nurikabe_solver::engine nurikabe_solver::parse_engine(const std::string &name) {
+    if (name == "search") return engine::search;
+    if (name == "dlx") return engine::dlx;
+    if (name == "sat") return engine::sat;
+    throw std::runtime_error("Невідомий алгоритм пошуку: " + name);
+}
 
-    // Список для зберігання вільних клітинок з числами
-    std::vector<cell> nums;
-    collect_numbers(nums);
+void nurikabe_solver::check_deadline() const {
+    if (deadline_ && clock::now() > *deadline_) {
+        throw std::runtime_error("Перевищено час розв'язання");
+    }
+}
 
-    if (nums.empty()) {
+bool nurikabe_solver::solve_recurse(int depth) {
+    check_deadline();
+    /*
+        Тимчасові буфери вузла і перебору шляхів беруться з арени його глибини: вона скидається при кожному вході,
+        тож після розігріву ці буфери не звертаються до купи. Поза ареною залишаються копії шляхів у path_stack_,
+        відновлення кроків (recover_step_by_step) і записи кешу кандидатів пар - вони живуть довше за вузол
+    */
+    search_arena::depth_scratch &scratch = arena_.at_depth(depth);
+    std::pmr::memory_resource *frame = &scratch.frame;
+
+    if (pairs_.remaining() == 0) {
         /*
             Якщо вільних клітинок не залишилося - заповнюємо можливі пропуски в сітці і перевіряємо чи є чорні блоки 2x2,
             якщо ні - рішення знайдено і повертаємо true, якщо так - відновлюєм пропуски і повертаємо false
         */
-        std::vector<cell> spaces;
+        std::pmr::vector<cell> spaces(frame);
         fill_spaces(spaces);
-        if (!has_black_2x2_block()) return true;
+        // Заповнені гравцем клітинки (next_hint), які не увійшли до жодного острова, щойно стали чорними
+        bool kept = std::none_of(fixed_white_.begin(), fixed_white_.end(),
+                                 [&](int id) { return grid_[id/cols_][id%cols_] == BLACK; });
+        if (kept && !has_black_2x2_block()) {
+            if (trace_ring_) trace_ring_->push(search_trace::solution, search_trace::none, depth, -1, -1, 0);
+            return true;
+        }
         for (auto &cc : spaces) grid_[cc.row][cc.col] = EMPTY;
+        if (trace_ring_) trace_ring_->push(search_trace::prune, search_trace::leaf_2x2, depth, -1, -1, 0);
+        return false;
+    }
+    // Якщо для якоїсь вільної підказки вже не залишилося жодної пари - ця гілка безнадійна
+    if (pairs_.has_isolated()) {
+        if (trace_ring_) trace_ring_->push(search_trace::prune, search_trace::isolated_clue, depth, -1, -1, 0);
         return false;
     }
-    // Створюємо список для зберігання кількості пар для кожної вершини, якщо для якоїсь вершини перестає існувати можлива пара - повертаємо false
-    std::vector<int> degree(rows_*cols_, 0);
-    // Заповнюємо список "degree" і пріоритетну чергу
-    for (size_t i = 0; i < nums.size(); ++i)
-        for (size_t j = i+1; j < nums.size(); ++j) {
-            cell a = nums[i], b = nums[j];
-            int tot = grid_[a.row][a.col] + grid_[b.row][b.col];
-            if (tot > manhattan(a,b)) {
-                anchor pr = std::minmax(a,b);
-                pq.push(pr);
-                degree[a.row*cols_ + a.col]++;
-                degree[b.row*cols_ + b.col]++;
-            }
-        }
 
-    // Перебираємо всі можливі пари, застосовуючи пріоритезацію
-    while (!pq.empty()) {
-        auto pr = pq.top(); pq.pop();
-        cell f = pr.first, c = pr.second;
-        int total = grid_[f.row][f.col] + grid_[c.row][c.col];
-        // Знаходимо всі шляхи між 2 вершинами
-        auto paths = find_all_valid_paths(f, c, total);
-        for (auto &path : paths) {
-            // Позначаємо поточний шлях як "FILLED", тобто уже сформовану область
-            for (int idx = 0; idx < rows_*cols_; ++idx) {
-                if (path[idx] && idx != f.row*cols_+f.col && idx != c.row*cols_+c.col)
-                    grid_[idx/cols_][idx%cols_] = FILLED;
-            }
-            /* 
-                Позначаємо всі сусідні клітинки області в чорний, попередньо записуючи їх у список для майбутнього можливого відновлення,
-                якщо шлях некоректний
-            */
-            std::vector<char> painted(rows_*cols_, 0);
-            paint_adjacent(path, painted);
+    /*
+        Граф пар зберігає степені вершин для всього пошуку, а tried - скільки пар кожної підказки вже
+        повністю перебрано в цьому вузлі; якщо для якоїсь вершини не залишається вільної пари - повертаємо false
+    */
+    std::pmr::vector<int> tried(pairs_.clue_count(), 0, frame);
+
+    // Список клітинок, пофарбованих у чорний поточним шляхом; після відкату він знову стає нульовим
+    std::pmr::vector<char> painted(rows_*cols_, 0, frame);
 
-            // Позначаємо вершини як "використані"
-            used_[f.row*cols_+f.col] = used_[c.row*cols_+c.col] = 1;
+    // Перебираємо всі живі пари в порядку пріоритету, обчисленому при побудові графа
+    for (int e = pairs_.first(); e != pair_graph::END; e = pairs_.next(e)) {
+        const pair_graph::edge &pr = pairs_.at(e);
+        cell f = pr.ca, c = pr.cb;
+        int total = pr.sum;
+        // Знаходимо всі шляхи між 2 вершинами, пам'ять шляхів попередньої пари повторно використовується
+        scratch.candidates.reset();
+        std::pmr::vector<Path> paths(&scratch.candidates);
+        pair_candidates(e, depth, paths, true);
+        for (size_t k = 0; k < paths.size(); ++k) {
+            const Path &path = paths[k];
+            // Розміщуємо острів і вирізаємо з графа всі пари, в яких брали участь його вершини
+            place_island(path, f, c, painted);
+            pairs_.select(e);
+            if (trace_ring_) trace_ring_->push(search_trace::decision, search_trace::none, depth, e, static_cast<int>(k), total);
             /*
                 Перевірка чи має поточна область чорні блоки 2 на 2 та чи чорна область зв'язна,
-                якщо - так викликаємо рекурсивно метод solve, якщо він повертає true - передаємо цей результат далі по стеку
+                якщо - так викликаємо рекурсивно метод solve, якщо він повертає true - передаємо цей результат далі по стеку.
+                Якщо на початку пошуку стан був коректним, island_fits уже відкинув такі острови
             */
-            if (!has_black_2x2_block() && is_black_area_connected() && solve_recurse()) {
+            bool pool = !local_exact_ && has_black_2x2_block();
+            bool split = !local_exact_ && !pool && !is_black_area_connected();
+            if (!pool && !split && solve_recurse(depth + 1)) {
                 path_stack_.push(path);
                 return true;
             }
 
-            // Шлях був неправильний, повертаємо вершини назад
-            used_[f.row*cols_+f.col] = used_[c.row*cols_+c.col] = 0;
-            // Шлях був неправильний, прибираємо позначення області як заповненої і перефарбовуємо сусідів в пусті клітинки
-            for (int idx = 0; idx < rows_*cols_; ++idx) {
-                if (path[idx] && idx != f.row*cols_+f.col && idx != c.row*cols_+c.col)
-                    grid_[idx/cols_][idx%cols_] = EMPTY;
-                if (painted[idx])
-                    grid_[idx/cols_][idx%cols_] = EMPTY;
+            // Шлях був неправильний, повертаємо вершини, їхні пари і клітинки назад
+            pairs_.undo();
+            remove_island(path, f, c, painted);
+            if (trace_ring_) {
+                search_trace::reason why = pool ? search_trace::black_2x2 : split ? search_trace::black_split : search_trace::none;
+                trace_ring_->push(search_trace::undo, why, depth, e, static_cast<int>(k), total);
             }
         }
         // Зменшуємо кількість пар для вершини f і c, якщо для якоїсь вершини не залишається вільної пари - повертаємо false
-        if (--degree[f.row*cols_+f.col] == 0 || --degree[c.row*cols_+c.col] == 0)
+        if (pairs_.degree(pr.a) == ++tried[pr.a] || pairs_.degree(pr.b) == ++tried[pr.b]) {
+            if (trace_ring_) trace_ring_->push(search_trace::prune, search_trace::pair_exhausted, depth, e, -1, 0);
             return false;
+        }
     }
     return false;
 }
 
+bool nurikabe_solver::solve_dlx() {
+    // Основні стовпці - підказки, рядок e покриває дві підказки ребра e графа пар
+    dlx_matrix matrix(pairs_.clue_count());
+    for (int e = 0; e < pairs_.edge_count(); ++e) {
+        matrix.add_row({pairs_.at(e).a, pairs_.at(e).b});
+    }
+
+    dlx_matrix::dlx_callbacks cb;
+    /*
+        Острови рядка генеруються для поточного стану сітки: перебрати всі острови всіх пар наперед на порожньому полі
+        неможливо, бо для великих сум їх мільйони. Кожне часткове покриття перевіряється на блоки 2x2 і зв'язність.
+        DLX не перебирає порядок пар, тому тут потрібна монотонна перевірка зв'язності: порожня кишеня між підказками,
+        яку ще заповнить острів іншої пари, не повинна відсікати гілку
+    */
+    cb.try_row = [&](int row, int depth, const std::function<bool()> &descend) {
+        check_deadline();
+        const pair_graph::edge &pr = pairs_.at(row);
+        search_arena::depth_scratch &scratch = arena_.at_depth(depth);
+        std::pmr::vector<char> painted(rows_*cols_, 0, &scratch.frame);
+        std::pmr::vector<Path> paths(&scratch.candidates);
+        pair_candidates(row, depth, paths, false);
+        for (auto &path : paths) {
+            place_island(path, pr.ca, pr.cb, painted);
+            if (!has_black_2x2_block() && can_black_area_connect() && descend()) {
+                path_stack_.push(path);
+                return true;
+            }
+            remove_island(path, pr.ca, pr.cb, painted);
+        }
+        return false;
+    };
+    // Повне покриття: решта порожніх клітинок стає чорною, вона має бути зв'язною і без блоків 2x2
+    cb.accept_cover = [&](int depth) {
+        std::pmr::vector<cell> spaces(&arena_.at_depth(depth).frame);
+        fill_spaces(spaces);
+        if (!has_black_2x2_block() && is_black_area_connected()) return true;
+        for (auto &cc : spaces) grid_[cc.row][cc.col] = EMPTY;
+        return false;
+    };
+    return matrix.search(cb);
+}
+
+// Обмеження "не більше одного" для списку змінних: попарно для коротких списків, послідовним кодуванням для довгих
+static void add_at_most_one(sat_solver &sat, const std::vector<int> &vars) {
+    int n = static_cast<int>(vars.size());
+    if (n <= 6) {
+        for (int i = 0; i < n; ++i)
+            for (int j = i + 1; j < n; ++j)
+                sat.add_clause({sat_solver::neg(vars[i]), sat_solver::neg(vars[j])});
+        return;
+    }
+    // s_i істинна, якщо серед перших i+1 змінних уже є істинна
+    int prev = sat.new_var();
+    sat.add_clause({sat_solver::neg(vars[0]), sat_solver::pos(prev)});
+    for (int i = 1; i < n; ++i) {
+        sat.add_clause({sat_solver::neg(vars[i]), sat_solver::neg(prev)});
+        if (i + 1 == n) break;
+        int cur = sat.new_var();
+        sat.add_clause({sat_solver::neg(vars[i]), sat_solver::pos(cur)});
+        sat.add_clause({sat_solver::neg(prev), sat_solver::pos(cur)});
+        prev = cur;
+    }
+}
+
+/*
+    Послідовний лічильник: рівно k змінних з vars істинні, якщо істинна when, і не більше k завжди.
+    count[i][j] еквівалентна "серед перших i+1 змінних щонайменше j+1 істинних"
+*/
+static void add_exactly_when(sat_solver &sat, const std::vector<int> &vars, int k, int when) {
+    using S = sat_solver;
+    int n = static_cast<int>(vars.size());
+    if (n < k) {
+        sat.add_clause({S::neg(when)});
+        return;
+    }
+    std::vector<std::vector<int>> count(n);
+    for (int i = 0; i < n; ++i) {
+        int top = std::min(i + 1, k + 1);
+        for (int j = 0; j < top; ++j) {
+            int c = sat.new_var();
+            count[i].push_back(c);
+            bool has_same = i > 0 && j < static_cast<int>(count[i - 1].size());
+            bool has_less = i > 0 && j > 0;
+            // Від'ємний напрямок: лічильник не може бути більшим, ніж дозволяють попередні значення
+            if (has_same) sat.add_clause({S::neg(count[i - 1][j]), S::pos(c)});
+            if (j == 0) sat.add_clause({S::neg(vars[i]), S::pos(c)});
+            else sat.add_clause({S::neg(count[i - 1][j - 1]), S::neg(vars[i]), S::pos(c)});
+            // Додатній напрямок: лічильник зростає лише за рахунок поточної змінної
+            if (has_same) sat.add_clause({S::neg(c), S::pos(count[i - 1][j]), S::pos(vars[i])});
+            else sat.add_clause({S::neg(c), S::pos(vars[i])});
+            if (has_less) {
+                if (has_same) sat.add_clause({S::neg(c), S::pos(count[i - 1][j]), S::pos(count[i - 1][j - 1])});
+                else sat.add_clause({S::neg(c), S::pos(count[i - 1][j - 1])});
+            }
+        }
+    }
+    if (static_cast<int>(count[n - 1].size()) > k) sat.add_clause({S::neg(count[n - 1][k])});
+    sat.add_clause({S::neg(when), S::pos(count[n - 1][k - 1])});
+}
+
+bool nurikabe_solver::solve_sat() {
+    using S = sat_solver;
+    const int n = rows_*cols_;
+    sat_solver sat;
+    sat.set_interrupt_hook([this] { check_deadline(); });
+
+    // Колір клітинки: істина - біла (підказка або острів), хибність - чорна
+    std::vector<int> white(n);
+    for (int id = 0; id < n; ++id) white[id] = sat.new_var();
+
+    // Для кожної клітинки - список підказок серед сусідів (острів не може торкатися чужої підказки)
+    std::vector<int> clue_at(n, -1);
+    for (int e = 0; e < pairs_.edge_count(); ++e) {
+        const pair_graph::edge &pr = pairs_.at(e);
+        clue_at[pr.ca.row*cols_ + pr.ca.col] = pr.a;
+        clue_at[pr.cb.row*cols_ + pr.cb.col] = pr.b;
+    }
+    for (int id = 0; id < n; ++id) {
+        if (grid_[id/cols_][id%cols_] > 0) sat.add_clause({S::pos(white[id])});
+    }
+    auto touches_other_clue = [&](int id, int a, int b) {
+        int r = id/cols_, c = id%cols_;
+        for (int d = 0; d < 4; ++d) {
+            int nr = r + DX_[d], nc = c + DY_[d];
+            if (out_of_bounds(nr,nc)) continue;
+            int k = clue_at[nr*cols_ + nc];
+            if (k >= 0 && k != a && k != b) return true;
+        }
+        return false;
+    };
+
+    /*
+        Для кожної пари: змінна вибору і змінні належності клітинок до її острова.
+        Змінні належності створюються лише для клітинок, куди острів може дотягнутися:
+        дерево Штейнера для f, c і x має щонайменше (d(f,x) + d(x,c) + d(f,c)) / 2 + 1 клітинок
+    */
+    int E = pairs_.edge_count();
+    std::vector<int> chosen(E);
+    std::vector<std::vector<int>> member(E, std::vector<int>(n, -1));
+    std::vector<std::vector<int>> reach(E);
+    std::vector<std::vector<int>> pairs_of(pairs_.clue_count());
+    std::vector<std::vector<int>> members_of(n);
+    for (int e = 0; e < E; ++e) {
+        const pair_graph::edge &pr = pairs_.at(e);
+        chosen[e] = sat.new_var();
+        pairs_of[pr.a].push_back(chosen[e]);
+        pairs_of[pr.b].push_back(chosen[e]);
+        int fid = pr.ca.row*cols_ + pr.ca.col, cid = pr.cb.row*cols_ + pr.cb.col;
+        for (int id = 0; id < n; ++id) {
+            cell x(id/cols_, id%cols_);
+            if (id != fid && id != cid) {
+                if (clue_at[id] >= 0 || grid_[x.row][x.col] != EMPTY || touches_other_clue(id, pr.a, pr.b)) continue;
+                int span = (manhattan(pr.ca, x) + manhattan(x, pr.cb) + manhattan(pr.ca, pr.cb)) / 2 + 1;
+                if (span > pr.sum) continue;
+            }
+            member[e][id] = sat.new_var();
+            reach[e].push_back(id);
+            members_of[id].push_back(member[e][id]);
+        }
+    }
+
+    // Кожна підказка входить рівно в одну обрану пару
+    for (auto &list : pairs_of) {
+        std::vector<S::lit> alo;
+        for (int v : list) alo.push_back(S::pos(v));
+        sat.add_clause(alo);
+        add_at_most_one(sat, list);
+    }
+
+    std::vector<int> island_vars;
+    for (int e = 0; e < E; ++e) {
+        const pair_graph::edge &pr = pairs_.at(e);
+        int fid = pr.ca.row*cols_ + pr.ca.col, cid = pr.cb.row*cols_ + pr.cb.col;
+        // Обрана пара містить обидві свої підказки, а клітинки острова - білі і належать лише обраній парі
+        sat.add_clause({S::neg(chosen[e]), S::pos(member[e][fid])});
+        sat.add_clause({S::neg(chosen[e]), S::pos(member[e][cid])});
+        island_vars.clear();
+        for (int id : reach[e]) {
+            int m = member[e][id];
+            island_vars.push_back(m);
+            sat.add_clause({S::neg(m), S::pos(chosen[e])});
+            sat.add_clause({S::neg(m), S::pos(white[id])});
+
+            int r = id/cols_, c = id%cols_;
+            std::vector<S::lit> has_neighbour = {S::neg(m)};
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DX_[d], nc = c + DY_[d];
+                if (out_of_bounds(nr,nc)) continue;
+                int nid = nr*cols_ + nc;
+                // Біла сусідня клітинка острова теж належить острову (острови не торкаються)
+                if (member[e][nid] >= 0) {
+                    sat.add_clause({S::neg(m), S::neg(white[nid]), S::pos(member[e][nid])});
+                    has_neighbour.push_back(S::pos(member[e][nid]));
+                } else {
+                    sat.add_clause({S::neg(m), S::neg(white[nid])});
+                }
+            }
+            // Острів з двох і більше клітинок не має ізольованих клітинок
+            sat.add_clause(has_neighbour);
+        }
+        // Розмір острова дорівнює сумі підказок
+        add_exactly_when(sat, island_vars, pr.sum, chosen[e]);
+    }
+
+    // Кожна біла клітинка належить рівно одному острову
+    for (int id = 0; id < n; ++id) {
+        std::vector<S::lit> cover = {S::neg(white[id])};
+        for (int m : members_of[id]) cover.push_back(S::pos(m));
+        sat.add_clause(cover);
+        add_at_most_one(sat, members_of[id]);
+    }
+
+    // Жодного чорного квадрата 2x2
+    for (int r = 0; r+1 < rows_; ++r)
+        for (int c = 0; c+1 < cols_; ++c)
+            sat.add_clause({S::pos(white[r*cols_+c]), S::pos(white[r*cols_+c+1]),
+                            S::pos(white[(r+1)*cols_+c]), S::pos(white[(r+1)*cols_+c+1])});
+
+    // Якщо чорних клітинок хоча б дві, кожна з них має чорного сусіда
+    int clue_total = 0;
+    for (int id = 0; id < n; ++id) clue_total += std::max(grid_[id/cols_][id%cols_], 0);
+    if (n - clue_total >= 2) {
+        for (int id = 0; id < n; ++id) {
+            std::vector<S::lit> lits = {S::pos(white[id])};
+            int r = id/cols_, c = id%cols_;
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DX_[d], nc = c + DY_[d];
+                if (!out_of_bounds(nr,nc)) lits.push_back(S::neg(white[nr*cols_+nc]));
+            }
+            sat.add_clause(lits);
+        }
+    }
+
+    /*
+        Зв'язність островів і чорної області перевіряється після кожної моделі тим самим обходом flood, що й у пошуку,
+        і для кожної знайденої розірваної компоненти C додається розріз: якщо клітинка з C разом з клітинкою поза нею
+        належать одній області, то хоча б одна клітинка з межі C теж має належати цій області
+    */
+    std::vector<int> comp(n);
+    auto boundary = [&](int label) {
+        std::vector<int> border;
+        std::vector<char> mark(n, 0);
+        for (int id = 0; id < n; ++id) {
+            if (comp[id] != label) continue;
+            int r = id/cols_, c = id%cols_;
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DX_[d], nc = c + DY_[d];
+                if (out_of_bounds(nr,nc)) continue;
+                int nid = nr*cols_ + nc;
+                if (comp[nid] != label && !mark[nid]) {
+                    mark[nid] = 1;
+                    border.push_back(nid);
+                }
+            }
+        }
+        return border;
+    };
+
+    for (;;) {
+        if (!sat.solve()) return false;
+        bool cut_added = false;
+
+        // Острови обраних пар
+        for (int e = 0; e < E; ++e) {
+            if (!sat.model_value(chosen[e])) continue;
+            const pair_graph::edge &pr = pairs_.at(e);
+            auto in_island = [&](int id) { return member[e][id] >= 0 && sat.model_value(member[e][id]); };
+            std::fill(comp.begin(), comp.end(), -1);
+            flood(pr.ca.row*cols_ + pr.ca.col, 0, comp, in_island);
+            int label = 1;
+            for (int id : reach[e]) {
+                if (comp[id] >= 0 || !in_island(id)) continue;
+                flood(id, label, comp, in_island);
+                std::vector<S::lit> cut = {S::neg(member[e][id])};
+                for (int b : boundary(label)) {
+                    if (member[e][b] >= 0) cut.push_back(S::pos(member[e][b]));
+                }
+                sat.add_clause(cut);
+                cut_added = true;
+                ++label;
+            }
+        }
+
+        // Чорна область
+        auto is_black = [&](int id) { return !sat.model_value(white[id]); };
+        std::fill(comp.begin(), comp.end(), -1);
+        int first_black = -1, label = 0;
+        for (int id = 0; id < n; ++id) {
+            if (comp[id] >= 0 || !is_black(id)) continue;
+            flood(id, label, comp, is_black);
+            if (first_black < 0) {
+                first_black = id;
+            } else {
+                std::vector<S::lit> cut = {S::pos(white[id]), S::pos(white[first_black])};
+                for (int b : boundary(label)) cut.push_back(S::neg(white[b]));
+                sat.add_clause(cut);
+                cut_added = true;
+            }
+            ++label;
+        }
+
+        if (cut_added) continue;
+
+        // Модель задовольняє всі обмеження - перетворюємо острови на шляхи для покрокового відновлення
+        for (int e = E - 1; e >= 0; --e) {
+            if (!sat.model_value(chosen[e])) continue;
+            Path path(n, 0);
+            for (int id : reach[e]) path[id] = sat.model_value(member[e][id]);
+            path_stack_.push(std::move(path));
+        }
+        return true;
+    }
+}
+
+std::vector<int> nurikabe_solver::island_order() const {
+    std::vector<int> order(rows_*cols_, 0);
+    std::stack<Path> paths = path_stack_;
+    for (int k = 1; !paths.empty(); ++k) {
+        const Path &path = paths.top();
+        for (int idx = 0; idx < rows_*cols_; ++idx) {
+            if (path[idx]) order[idx] = k;
+        }
+        paths.pop();
+    }
+    return order;
+}
+
+void nurikabe_solver::push_island_order(const std::vector<int> &order) {
+    int islands = 0;
+    for (int k : order) islands = std::max(islands, k);
+    std::vector<Path> paths(islands, Path(rows_*cols_, 0));
+    for (int idx = 0; idx < rows_*cols_; ++idx) {
+        if (order[idx]) paths[order[idx] - 1][idx] = 1;
+    }
+    for (int k = islands - 1; k >= 0; --k) path_stack_.push(std::move(paths[k]));
+}
+
 std::vector<nurikabe_solver::grid> nurikabe_solver::recover_step_by_step() {
     std::vector<grid> steps;
     grid current = initial_grid_;
@@ -177,35 +537,37 @@ std::vector<nurikabe_solver::grid> nurikabe_solver::recover_step_by_step() {
     return steps;
 }
 
-// Метод для зібрання клітинок з числами в список
-void nurikabe_solver::collect_numbers(std::vector<cell> &cells) {
-    cells.clear();
-    for (int r = 0; r < rows_; ++r) {
-        for (int c = 0; c < cols_; ++c) {
-            int id = r*cols_ + c;
-            if (grid_[r][c] > 0 && !used_[id]) {
-                cells.emplace_back(r,c);
-            }
-        }
-    }
-}
-
 // Метод для знаходження всіх можливіх шляхів між 2 вершинами
-std::vector<nurikabe_solver::Path>
-nurikabe_solver::find_all_valid_paths(cell start, cell end, int totalSize) {
-    using Path = std::vector<char>;
+void nurikabe_solver::find_all_valid_paths(cell start, cell end, int totalSize, std::pmr::vector<Path> &result) {
+    using path_map = std::pmr::unordered_map<Path,cell,PathHash,PathEq>;
     /* 
-        Створюємо map для зберігання унікальних шляхів, prev для шляхів k довжини і curr для шляхів k+1 довжини
+        Створюємо map для зберігання унікальних шляхів, levels[len%2] зберігає шляхи довжини len.
+        Кожен рівень живе у власній області арени, яка скидається, щойно рівень стає непотрібним.
         Значення для кожного шляху в мепі - це найближча клітинка до кінця, допомагає завчасно обрізати "безнадійні" шляхи
     */
-    std::unordered_map<Path,cell,PathHash,PathEq> prev, curr;
-    // Ініціалізуємо prev шляхами довжиною 1 - а саме шляхом з однієї стартової клітини
-    Path init(rows_*cols_, 0);
+    std::optional<path_map> levels[2];
+    auto open_level = [&](int len) -> path_map & {
+        std::optional<path_map> &slot = levels[len % 2];
+        // Новий рівень успадковує кількість кошиків рівня, який жив у цьому ж слоті, і не перехешовується з нуля
+        size_t buckets = slot ? slot->bucket_count() : 0;
+        slot.reset();
+        depth_arena &mem = arena_.level(len % 2);
+        mem.reset();
+        return slot.emplace(buckets, PathHash{}, PathEq{}, &mem);
+    };
+
+    // Ініціалізуємо рівень 1 шляхом з однієї стартової клітини
+    path_map &first = open_level(1);
+    Path init(rows_*cols_, 0, first.get_allocator());
     init[start.row*cols_ + start.col] = 1;
-    prev.emplace(init, start);
+    first.emplace(std::move(init), start);
+    // Буфер для збирання кандидатів у шляхи, живе в області поточної глибини пошуку
+    Path probe(rows_*cols_, 0, result.get_allocator());
 
     // Шукаємо всі шляхи довжини [1, totalSize] зберігаючи тільки останні
     for (int len = 1; len < totalSize; ++len) {
+        path_map &prev = *levels[len % 2];
+        path_map &curr = open_level(len + 1);
         for (auto &kv : prev) {
             const auto &mask = kv.first;
             cell close = kv.second;
@@ -225,25 +587,158 @@ nurikabe_solver::find_all_valid_paths(cell start, cell end, int totalSize) {
                     if (!is_expandable(nb,end,mask)) continue;
                     // Якщо це шлях максимальної (totalSize) довжини і в ньому немає end - пропускаємо
                     if (len==totalSize-1 && !mask[end.row*cols_+end.col] && nid != end.row*cols_+end.col) continue;
-                    // Копіюємо шлях (len-1) довжини і додаємо до нього поточну клітинку
-                    Path np = mask; np[nid] = 1;
+                    /*
+                        Збираємо новий шлях у перевикористовуваному буфері і копіюємо його в область наступного рівня
+                        лише якщо такого шляху ще немає: монотонна арена не повертає пам'ять дублікатів
+                    */
+                    probe.assign(mask.begin(), mask.end()); probe[nid] = 1;
+                    if (curr.find(probe) != curr.end()) continue;
                     // Знаходимо нову найближчу клітинку до кінця
                     cell nclose = (manhattan(nb,end)<manhattan(close,end) ? nb : close);
-                    curr.emplace(std::move(np), nclose);
+                    curr.emplace(Path(probe, curr.get_allocator()), nclose);
                 }
             }
         }
-        // Тепер curr зберігатиме шляхи довжиною len + 1, тому свапаємо prev і curr і очищаємо curr
-        prev.swap(curr);
-        curr.clear();
     }
 
-    // Зберігаємо результат в вектор
-    std::vector<Path> result;
-    for (auto &kv : prev) {
-        result.push_back(kv.first);
+    // Копіюємо результат у вектор, пам'ять якого належить викликачу
+    for (auto &kv : *levels[totalSize % 2]) result.push_back(kv.first);
+}
+
+// Метод для отримання островів пари з кешу або перебором
+void nurikabe_solver::pair_candidates(int e, int depth, std::pmr::vector<Path> &result, bool require_connected) {
+    const pair_graph::edge &pr = pairs_.at(e);
+    const int n = rows_*cols_;
+    auto fits = [&](const Path &path) {
+        if (!fixed_white_.empty() && !keeps_fixed_white(path)) return false;
+        search_trace::reason why = search_trace::none;
+        if (island_fits(path, require_connected, why)) return true;
+        // Без цього запису острови, які раніше відкочувалися з причиною, зникли б із журналу пошуку
+        if (trace_ring_) trace_ring_->push(search_trace::prune, why, depth, e, -1, pr.sum);
+        return false;
+    };
+
+    /*
+        Запис дійсний, поки чорні клітинки досяжної області, зафіксовані під час перебору, залишаються чорними:
+        тоді нових островів бути не може, а кешовані острови, що зачіпають нові чорні клітинки, відкидаються.
+        Заповнені клітинки розміщених островів оточені чорними, тож окремо їх перевіряти не потрібно
+    */
+    auto black = [&](int id) { return grid_[id/cols_][id%cols_] == BLACK; };
+    if (const candidate_cache::entry *en = candidates_.lookup(e, black)) {
+        const int *cells = en->cells.data();
+        for (int k = 0, cnt = en->count(); k < cnt; ++k, cells += en->size) {
+            if (std::any_of(cells, cells + en->size, black)) continue;
+            result.emplace_back(n, 0);
+            for (int i = 0; i < en->size; ++i) result.back()[cells[i]] = 1;
+            if (!fits(result.back())) result.pop_back();
+        }
+        return;
     }
-    return result;
+
+    find_all_valid_paths(pr.ca, pr.cb, pr.sum, result);
+
+    // Знімок чорних клітинок досяжної області і клітинки кожного острова
+    std::vector<int> blocked;
+    for (int id = 0; id < n; ++id) {
+        cell x(id/cols_, id%cols_);
+        if (grid_[x.row][x.col] != BLACK) continue;
+        if ((manhattan(pr.ca, x) + manhattan(x, pr.cb) + manhattan(pr.ca, pr.cb)) / 2 + 1 > pr.sum) continue;
+        blocked.push_back(id);
+    }
+    std::vector<int> cells;
+    cells.reserve(result.size() * pr.sum);
+    for (const Path &path : result) {
+        for (int id = 0; id < n; ++id) {
+            if (path[id]) cells.push_back(id);
+        }
+    }
+    candidates_.store(e, std::move(blocked), std::move(cells), pr.sum);
+
+    result.erase(std::remove_if(result.begin(), result.end(), [&](const Path &path) { return !fits(path); }), result.end());
+}
+
+// Метод для локальної перевірки острова перед тим, як видати його пошуку
+bool nurikabe_solver::island_fits(const Path &path, bool require_connected, search_trace::reason &why) {
+    const int n = rows_*cols_;
+    if (border_mark_.size() != static_cast<size_t>(n)) {
+        border_mark_.assign(n, 0);
+        seen_mark_.assign(n, 0);
+        fit_epoch_ = 0;
+    }
+    if (++fit_epoch_ == 0) {
+        std::fill(border_mark_.begin(), border_mark_.end(), 0);
+        std::fill(seen_mark_.begin(), seen_mark_.end(), 0);
+        fit_epoch_ = 1;
+    }
+
+    // Сусіди острова, які paint_adjacent пофарбує в чорний, і рамка острова
+    std::vector<int> &border = fit_border_;
+    border.clear();
+    int top = rows_, bottom = -1, left = cols_, right = -1;
+    for (int idx = 0; idx < n; ++idx) {
+        if (!path[idx]) continue;
+        int r = idx/cols_, c = idx%cols_;
+        top = std::min(top, r); bottom = std::max(bottom, r);
+        left = std::min(left, c); right = std::max(right, c);
+        for (int d = 0; d < 4; ++d) {
+            int nr = r + DX_[d], nc = c + DY_[d];
+            if (out_of_bounds(nr,nc)) continue;
+            int nid = nr*cols_ + nc;
+            if (path[nid] || border_mark_[nid] == fit_epoch_) continue;
+            border_mark_[nid] = fit_epoch_;
+            border.push_back(nid);
+        }
+    }
+
+    // Вікна 2x2 з пофарбованою клітинкою: чорні вже або стануть чорними всі чотири клітинки
+    auto dark = [&](int r, int c) { return grid_[r][c] == BLACK || border_mark_[r*cols_ + c] == fit_epoch_; };
+    why = search_trace::black_2x2;
+    for (int id : border) {
+        int r = id/cols_, c = id%cols_;
+        for (int wr = std::max(r - 1, 0); wr <= r && wr + 1 < rows_; ++wr)
+            for (int wc = std::max(c - 1, 0); wc <= c && wc + 1 < cols_; ++wc)
+                if (dark(wr, wc) && dark(wr + 1, wc) && dark(wr, wc + 1) && dark(wr + 1, wc + 1)) return false;
+    }
+    if (!require_connected || border.size() < 2) return true;
+    why = search_trace::black_split;
+
+    /*
+        Обхід чорних і порожніх клітинок поза островом від першого сусіда: спершу лише у вікні
+        на 2 клітинки ширшому за рамку острова, потім, якщо не всіх сусідів досягнуто, - по всій сітці
+    */
+    size_t borders = border.size();
+    int first = border[0];
+    auto reached_all = [&](int r0, int r1, int c0, int c1) {
+        std::vector<int> &queue = fit_queue_;
+        queue.assign(1, first);
+        seen_mark_[first] = fit_epoch_;
+        size_t found = 1;
+        for (size_t qi = 0; qi < queue.size() && found < borders; ++qi) {
+            int r = queue[qi]/cols_, c = queue[qi]%cols_;
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DX_[d], nc = c + DY_[d];
+                if (nr < r0 || nr > r1 || nc < c0 || nc > c1) continue;
+                int nid = nr*cols_ + nc;
+                if (seen_mark_[nid] == fit_epoch_ || path[nid]) continue;
+                if (grid_[nr][nc] != BLACK && grid_[nr][nc] != EMPTY) continue;
+                seen_mark_[nid] = fit_epoch_;
+                if (border_mark_[nid] == fit_epoch_) ++found;
+                queue.push_back(nid);
+            }
+        }
+        return found == borders;
+    };
+    if (reached_all(std::max(top - 2, 0), std::min(bottom + 2, rows_ - 1),
+                    std::max(left - 2, 0), std::min(right + 2, cols_ - 1))) return true;
+    ++fit_epoch_;
+    if (fit_epoch_ == 0) {
+        std::fill(border_mark_.begin(), border_mark_.end(), 0);
+        std::fill(seen_mark_.begin(), seen_mark_.end(), 0);
+        fit_epoch_ = 1;
+    }
+    // Нова епоха скинула позначки сусідів - відновлюємо їх
+    for (int id : border) border_mark_[id] = fit_epoch_;
+    return reached_all(0, rows_ - 1, 0, cols_ - 1);
 }
 
 // Метод для знаходження манхетенського (найкоротшого) шляху
@@ -267,8 +762,35 @@ bool nurikabe_solver::out_of_bounds(int r, int c) const {
     return r<0 || c<0 || r>=rows_ || c>=cols_;
 }
 
+// Метод для розміщення острова: клітинки шляху стають заповненими, сусіди - чорними, підказки - використаними
+void nurikabe_solver::place_island(const Path &path, cell f, cell c, std::pmr::vector<char> &painted) {
+    for (int idx = 0; idx < rows_*cols_; ++idx) {
+        if (path[idx] && idx != f.row*cols_+f.col && idx != c.row*cols_+c.col)
+            grid_[idx/cols_][idx%cols_] = FILLED;
+    }
+    /*
+        Позначаємо всі сусідні клітинки області в чорний, попередньо записуючи їх у список для майбутнього можливого відновлення,
+        якщо шлях некоректний
+    */
+    paint_adjacent(path, painted);
+    used_[f.row*cols_+f.col] = used_[c.row*cols_+c.col] = 1;
+}
+
+// Метод для відкату острова: прибираємо позначення області як заповненої і перефарбовуємо сусідів в пусті клітинки
+void nurikabe_solver::remove_island(const Path &path, cell f, cell c, std::pmr::vector<char> &painted) {
+    used_[f.row*cols_+f.col] = used_[c.row*cols_+c.col] = 0;
+    for (int idx = 0; idx < rows_*cols_; ++idx) {
+        if (path[idx] && idx != f.row*cols_+f.col && idx != c.row*cols_+c.col)
+            grid_[idx/cols_][idx%cols_] = EMPTY;
+        if (painted[idx]) {
+            grid_[idx/cols_][idx%cols_] = EMPTY;
+            painted[idx] = 0;
+        }
+    }
+}
+
 // Метод для фарбування сусідніх клітинок області в чорний колір і попереднє збереження їх в список "painted" для майбутнього можливого відновлення
-void nurikabe_solver::paint_adjacent(const Path &path, std::vector<char> &painted) {
+void nurikabe_solver::paint_adjacent(const Path &path, std::pmr::vector<char> &painted) {
     for (int idx = 0; idx < rows_*cols_; ++idx) {
         if (!path[idx]) continue;
         int r = idx/cols_, c = idx%cols_;
@@ -284,8 +806,8 @@ void nurikabe_solver::paint_adjacent(const Path &path, std::vector<char> &painte
 
 // Метод для перевірки зв'язності чорної області
 bool nurikabe_solver::is_black_area_connected() const {
-    // Список visited для зберігання пройдених клітинок
-    std::vector<char> vis(rows_*cols_, 0);
+    // Список visited для зберігання пройдених клітинок (буфер розв'язувача, щоб не виділяти пам'ять на кожну перевірку)
+    visited_.assign(rows_*cols_, -1);
     // st - стартова клітинка, found - чи була знайдена стартова клітинка, cnt - кількість чорних клітинок
     int start = -1, cnt = 0;
     for (int r = 0; r < rows_; ++r) {
@@ -307,22 +829,29 @@ bool nurikabe_solver::is_black_area_connected() const {
         Перевіряємо чи збігається кількість усіх чорних клітинок з кількістю досяжних клітинок починаючи з start
         (якщо область зв'язна, вони повинні співпадати)
     */
-    return dfs_count_black(vis, {start/cols_, start%cols_}) == cnt;
+    return flood(start, 0, visited_, [&](int id) { return black_or_empty(id); }) == cnt;
 }
 
-// Метод для підрахунку всіх досяжних чорних клітинок починаючи з start
-int nurikabe_solver::dfs_count_black(std::vector<char> &vis, cell c) const {
-    int id = c.row*cols_ + c.col;
-    vis[id] = 1;
-    int sum = 1;
-    for (int d = 0; d < 4; ++d) {
-        int nr = c.row + DX_[d], nc = c.col + DY_[d];
-        int nid = nr*cols_ + nc;
-        if (out_of_bounds(nr,nc) || vis[nid]) continue;
-        if (grid_[nr][nc]!=BLACK && grid_[nr][nc]!=EMPTY) continue;
-        sum += dfs_count_black(vis, {nr,nc});
+// Метод для перевірки, чи можуть усі чорні клітинки ще з'єднатися через порожні
+bool nurikabe_solver::can_black_area_connect() const {
+    visited_.assign(rows_*cols_, -1);
+    int start = -1;
+    for (int id = 0; id < rows_*cols_ && start < 0; ++id) {
+        if (grid_[id/cols_][id%cols_] == BLACK) start = id;
     }
-    return sum;
+    if (start < 0) return true;
+    // Обходимо компоненту першої чорної клітинки і перевіряємо, що в неї потрапили всі інші чорні
+    flood(start, 0, visited_, [&](int id) { return black_or_empty(id); });
+    for (int id = 0; id < rows_*cols_; ++id) {
+        if (grid_[id/cols_][id%cols_] == BLACK && visited_[id] < 0) return false;
+    }
+    return true;
+}
+
+// Клітинка, яка є або ще може стати частиною чорної області
+bool nurikabe_solver::black_or_empty(int id) const {
+    int v = grid_[id/cols_][id%cols_];
+    return v == BLACK || v == EMPTY;
 }
 
 // Метод для перевірки існування чорних блоків 2x2
@@ -339,7 +868,7 @@ bool nurikabe_solver::has_black_2x2_block() const {
 }
 
 // Метод для заповнення можливих пропусків в кінці і попередній запис їх в список spaces для майбутнього можливого відновлення
-void nurikabe_solver::fill_spaces(std::vector<cell> &spaces) {
+void nurikabe_solver::fill_spaces(std::pmr::vector<cell> &spaces) {
     spaces.clear();
     for (int r = 0; r < rows_; ++r) {
         for (int c = 0; c < cols_; ++c) {
@@ -350,3 +879,330 @@ void nurikabe_solver::fill_spaces(std::vector<cell> &spaces) {
         }
     }
 }
+
+// Пошук підказки для часткового розв'язку гравця
+nurikabe_solver::hint nurikabe_solver::next_hint(const grid &partial, std::chrono::milliseconds budget) {
+    rows_ = static_cast<int>(partial.size());
+    cols_ = rows_ ? static_cast<int>(partial[0].size()) : 0;
+    for (const auto &row : partial) {
+        if (static_cast<int>(row.size()) != cols_) {
+            rows_ = cols_ = 0;
+            throw std::runtime_error("Рядки сітки мають різну довжину");
+        }
+        for (int v : row) {
+            if (v < FILLED) {
+                rows_ = cols_ = 0;
+                throw std::runtime_error("Недопустиме значення клітинки " + std::to_string(v));
+            }
+        }
+    }
+
+    // Робоча сітка - стан гравця, початкова - лише підказки
+    while (!path_stack_.empty()) path_stack_.pop();
+    fixed_white_.clear();
+    trace_ring_ = trace_ ? &trace_->local() : nullptr;
+    grid_ = partial;
+    initial_grid_ = partial;
+    for (auto &row : initial_grid_)
+        for (int &v : row) v = std::max(v, 0);
+    used_.assign(rows_*cols_, 0);
+
+    hint res;
+    std::vector<region> white = regions(false);
+    if (find_contradiction(white, res)) {
+        rows_ = cols_ = 0;
+        return res;
+    }
+
+    // Завершені гравцем острови вважаються розміщеними: їхні пари вирізаються з графа
+    pairs_.build(initial_grid_);
+    candidates_.reset(pairs_.edge_count());
+    for (const region &reg : white) {
+        if (reg.clues != 2 || static_cast<int>(reg.cells.size()) != reg.clue_sum) continue;
+        cell a(-1, -1), b(-1, -1);
+        for (int id : reg.cells) {
+            if (grid_[id/cols_][id%cols_] <= 0) continue;
+            (a.row < 0 ? a : b) = cell(id/cols_, id%cols_);
+            used_[id] = 1;
+        }
+        // Ребра графа впорядковані за обходом сітки
+        if (b < a) std::swap(a, b);
+        for (int e = 0; e < pairs_.edge_count(); ++e) {
+            if (pairs_.at(e).ca == a && pairs_.at(e).cb == b) {
+                pairs_.select(e);
+                break;
+            }
+        }
+    }
+
+    if (find_forced_cells(white, res)) {
+        rows_ = cols_ = 0;
+        return res;
+    }
+
+    // Без порожніх клітинок і суперечностей кожен острів завершений, а чорна область зв'язна
+    bool any_empty = false;
+    for (const auto &row : grid_)
+        for (int v : row) any_empty |= v == EMPTY;
+    if (!any_empty) {
+        rows_ = cols_ = 0;
+        res.kind = hint::solved;
+        res.reason = "Рішення завершене";
+        return res;
+    }
+
+    /*
+        Пошук з поточного стану: заповнені клітинки незавершених островів повертаються в порожні,
+        але кожен острів, що торкається такої клітинки, мусить її містити, і в кінці жодна з них не може стати чорною
+    */
+    for (const region &reg : white) {
+        if (reg.clues == 2 && static_cast<int>(reg.cells.size()) == reg.clue_sum) continue;
+        for (int id : reg.cells) {
+            if (grid_[id/cols_][id%cols_] != FILLED) continue;
+            grid_[id/cols_][id%cols_] = EMPTY;
+            fixed_white_.push_back(id);
+        }
+    }
+
+    std::optional<clock::time_point> saved = deadline_;
+    clock::time_point limit = clock::now() + budget;
+    if (!deadline_ || limit < *deadline_) deadline_ = limit;
+    bool found;
+    try {
+        local_exact_ = !has_black_2x2_block() && is_black_area_connected();
+        found = solve_recurse(0);
+    } catch (const std::runtime_error &) {
+        deadline_ = saved;
+        fixed_white_.clear();
+        rows_ = cols_ = 0;
+        res.kind = hint::timeout;
+        res.reason = "За відведений час підказку не знайдено";
+        return res;
+    }
+    deadline_ = saved;
+    fixed_white_.clear();
+
+    if (!found) {
+        rows_ = cols_ = 0;
+        res.kind = hint::contradiction;
+        res.reason = "З поточного стану рішення не існує";
+        return res;
+    }
+
+    // Найдешевший крок - острів рішення, якому бракує найменше клітинок
+    int best_missing = 0;
+    while (!path_stack_.empty()) {
+        const Path &path = path_stack_.top();
+        int missing = 0;
+        for (int id = 0; id < rows_*cols_; ++id) {
+            if (path[id] && partial[id/cols_][id%cols_] == EMPTY) ++missing;
+        }
+        if (missing > 0 && (best_missing == 0 || missing < best_missing)) {
+            best_missing = missing;
+            res.cells.clear();
+            for (int id = 0; id < rows_*cols_; ++id) {
+                if (path[id]) res.cells.emplace_back(id/cols_, id%cols_);
+            }
+        }
+        path_stack_.pop();
+    }
+    if (best_missing > 0) {
+        res.kind = hint::island;
+        res.reason = "Острів, якому бракує " + std::to_string(best_missing) + " клітинок";
+    } else {
+        // Усі острови вже на місці - решта порожніх клітинок чорні
+        res.kind = hint::black_cell;
+        res.reason = "Усі острови завершені, решта клітинок чорні";
+        for (int id = 0; id < rows_*cols_; ++id) {
+            if (partial[id/cols_][id%cols_] == EMPTY) res.cells.emplace_back(id/cols_, id%cols_);
+        }
+    }
+    rows_ = cols_ = 0;
+    return res;
+}
+
+// Метод для пошуку зв'язних областей білих або чорних клітинок
+std::vector<nurikabe_solver::region> nurikabe_solver::regions(bool black) const {
+    std::vector<region> res;
+    std::vector<int> label(rows_*cols_, -1), seen(rows_*cols_, -1);
+    auto inside = [&](int r, int c) {
+        int v = grid_[r][c];
+        return black ? v == BLACK : (v > 0 || v == FILLED);
+    };
+    for (int start = 0; start < rows_*cols_; ++start) {
+        if (label[start] >= 0 || !inside(start/cols_, start%cols_)) continue;
+        int k = static_cast<int>(res.size());
+        res.emplace_back();
+        region &reg = res.back();
+        label[start] = k;
+        reg.cells.push_back(start);
+        for (size_t i = 0; i < reg.cells.size(); ++i) {
+            int id = reg.cells[i], r = id/cols_, c = id%cols_;
+            if (grid_[r][c] > 0) {
+                reg.clues++;
+                reg.clue_sum += grid_[r][c];
+            }
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DX_[d], nc = c + DY_[d];
+                if (out_of_bounds(nr,nc)) continue;
+                int nid = nr*cols_ + nc;
+                if (grid_[nr][nc] == EMPTY) {
+                    // seen - номер останньої області, яка вже врахувала цю порожню клітинку
+                    if (seen[nid] != k) {
+                        seen[nid] = k;
+                        reg.liberties.push_back(nid);
+                    }
+                } else if (label[nid] < 0 && inside(nr, nc)) {
+                    label[nid] = k;
+                    reg.cells.push_back(nid);
+                }
+            }
+        }
+    }
+    return res;
+}
+
+// Метод для пошуку явних суперечностей у стані гравця
+bool nurikabe_solver::find_contradiction(const std::vector<region> &white, hint &out) const {
+    out.kind = hint::contradiction;
+    for (int r = 0; r+1 < rows_; ++r) {
+        for (int c = 0; c+1 < cols_; ++c) {
+            if (grid_[r][c]==BLACK && grid_[r+1][c]==BLACK && grid_[r][c+1]==BLACK && grid_[r+1][c+1]==BLACK) {
+                out.cells = {cell(r,c), cell(r,c+1), cell(r+1,c), cell(r+1,c+1)};
+                out.reason = "Чорний блок 2x2";
+                return true;
+            }
+        }
+    }
+    for (const region &reg : white) {
+        int size = static_cast<int>(reg.cells.size());
+        if (reg.clues > 2) {
+            out.reason = "Острів має більше 2 підказок";
+        } else if (reg.clues == 2 && size > reg.clue_sum) {
+            out.reason = "Площа острова більша за суму підказок";
+        } else if (reg.liberties.empty() && reg.clues < 2) {
+            out.reason = "Замкнений острів має менше ніж 2 підказки";
+        } else if (reg.liberties.empty() && size != reg.clue_sum) {
+            out.reason = "Площа замкненого острова не дорівнює сумі підказок";
+        } else {
+            continue;
+        }
+        out.cells.clear();
+        for (int id : reg.cells) out.cells.emplace_back(id/cols_, id%cols_);
+        return true;
+    }
+    // Чорні клітинки, які вже не з'єднати з рештою навіть через порожні
+    if (!can_black_area_connect()) {
+        out.cells.clear();
+        for (int id = 0; id < rows_*cols_; ++id) {
+            if (grid_[id/cols_][id%cols_] == BLACK && visited_[id] < 0) out.cells.emplace_back(id/cols_, id%cols_);
+        }
+        out.reason = "Чорна частина відрізана від решти";
+        return true;
+    }
+    return false;
+}
+
+// Метод для пошуку клітинок, колір яких випливає з локальних правил
+bool nurikabe_solver::find_forced_cells(const std::vector<region> &white, hint &out) const {
+    out.cells.clear();
+    auto done = [&](hint::kind_t kind, const char *reason) {
+        if (out.cells.empty()) return false;
+        out.kind = kind;
+        out.reason = reason;
+        return true;
+    };
+    auto add_ids = [&](const std::vector<int> &ids) {
+        for (int id : ids) out.cells.emplace_back(id/cols_, id%cols_);
+    };
+
+    // Сусіди завершеного острова
+    for (const region &reg : white) {
+        if (reg.clues == 2 && static_cast<int>(reg.cells.size()) == reg.clue_sum) add_ids(reg.liberties);
+    }
+    if (done(hint::black_cell, "Сусіди завершеного острова - чорні")) return true;
+
+    // Порожня клітинка, яка з'єднала б острови з трьома підказками або в завеликий острів
+    std::vector<int> label(rows_*cols_, -1);
+    for (int k = 0; k < static_cast<int>(white.size()); ++k)
+        for (int id : white[k].cells) label[id] = k;
+    for (int id = 0; id < rows_*cols_; ++id) {
+        int r = id/cols_, c = id%cols_;
+        if (grid_[r][c] != EMPTY) continue;
+        int joined[4], n = 0, clues = 0, size = 1, sum = 0;
+        for (int d = 0; d < 4; ++d) {
+            int nr = r + DX_[d], nc = c + DY_[d];
+            if (out_of_bounds(nr,nc) || label[nr*cols_+nc] < 0) continue;
+            int k = label[nr*cols_+nc];
+            if (std::find(joined, joined + n, k) != joined + n) continue;
+            joined[n++] = k;
+            clues += white[k].clues;
+            sum += white[k].clue_sum;
+            size += static_cast<int>(white[k].cells.size());
+        }
+        if (clues > 2 || (clues == 2 && size > sum)) out.cells.emplace_back(r, c);
+    }
+    if (done(hint::black_cell, "Клітинка з'єднала б острови в неприпустимий")) return true;
+
+    // Вікно 2x2 з трьома чорними клітинками
+    for (int r = 0; r+1 < rows_; ++r) {
+        for (int c = 0; c+1 < cols_; ++c) {
+            int black = 0;
+            cell gap(-1, -1);
+            for (int dr = 0; dr < 2; ++dr)
+                for (int dc = 0; dc < 2; ++dc) {
+                    if (grid_[r+dr][c+dc] == BLACK) ++black;
+                    else if (grid_[r+dr][c+dc] == EMPTY) gap = cell(r+dr, c+dc);
+                }
+            if (black == 3 && gap.row >= 0 && std::find(out.cells.begin(), out.cells.end(), gap) == out.cells.end())
+                out.cells.push_back(gap);
+        }
+    }
+    if (done(hint::white_cell, "Четверта клітинка вікна 2x2 з трьома чорними - біла")) return true;
+
+    // Незавершений острів з єдиним виходом
+    for (const region &reg : white) {
+        bool complete = reg.clues == 2 && static_cast<int>(reg.cells.size()) == reg.clue_sum;
+        if (!complete && reg.liberties.size() == 1 &&
+            std::find(out.cells.begin(), out.cells.end(), cell(reg.liberties[0]/cols_, reg.liberties[0]%cols_)) == out.cells.end())
+            add_ids(reg.liberties);
+    }
+    if (done(hint::white_cell, "Єдиний вихід незавершеного острова")) return true;
+
+    // Чорна частина з єдиним виходом, якщо вона не єдина
+    std::vector<region> black = regions(true);
+    if (black.size() > 1) {
+        for (const region &reg : black) {
+            if (reg.liberties.size() == 1 &&
+                std::find(out.cells.begin(), out.cells.end(), cell(reg.liberties[0]/cols_, reg.liberties[0]%cols_)) == out.cells.end())
+                add_ids(reg.liberties);
+        }
+    }
+    if (done(hint::black_cell, "Єдиний вихід чорної частини")) return true;
+
+    // Порожні клітинки, до яких не дотягнеться острів жодної живої пари
+    for (int id = 0; id < rows_*cols_; ++id) {
+        cell x(id/cols_, id%cols_);
+        if (grid_[x.row][x.col] != EMPTY) continue;
+        bool reachable = false;
+        for (int e = pairs_.first(); e != pair_graph::END && !reachable; e = pairs_.next(e)) {
+            const pair_graph::edge &pr = pairs_.at(e);
+            reachable = (manhattan(pr.ca, x) + manhattan(x, pr.cb) + manhattan(pr.ca, pr.cb)) / 2 + 1 <= pr.sum;
+        }
+        if (!reachable) out.cells.push_back(x);
+    }
+    return done(hint::black_cell, "До клітинки не дотягнеться жоден острів");
+}
+
+// Метод для перевірки, що шлях не зачіпає чужих заповнених гравцем клітинок
+bool nurikabe_solver::keeps_fixed_white(const Path &path) const {
+    for (int id : fixed_white_) {
+        if (path[id]) continue;
+        int r = id/cols_, c = id%cols_;
+        for (int d = 0; d < 4; ++d) {
+            int nr = r + DX_[d], nc = c + DY_[d];
+            if (!out_of_bounds(nr,nc) && path[nr*cols_ + nc]) return false;
+        }
+    }
+    return true;
+}
@@ -4,7 +4,17 @@
 #include <iostream>
 #include <stack>
 #include <set>
+#include <memory_resource>
+#include <optional>
+#include <chrono>
+#include <string>
 #include "Cell.hpp"
+#include "search_arena.hpp"
+#include "pair_graph.hpp"
+#include "search_trace.hpp"
+#include "candidate_cache.hpp"
+
+class solution_cache;
 
 // Клас, що реалізує розв'язувач головоломки Nurikabe (пари чисел)
 class nurikabe_solver {
@@ -16,10 +26,17 @@ public:
         FILLED = -2    // заповнена клітинка острова (не число)
     };
 
+    // Доступні алгоритми пошуку
+    enum class engine {
+        search,     // перебір пар за фіксованим пріоритетом (solve_recurse)
+        dlx,        // точне покриття на танцюючих посиланнях з вибором стовпця за MRV
+        sat         // кодування в КНФ і вбудований CDCL-розв'язувач
+    };
+
     // Скорочена назва для сітки
     using grid = std::vector<std::vector<int>>;
-    // Одновимірна бітова маска шляху
-    using Path = std::vector<char>;
+    // Одновимірна бітова маска шляху (пам'ять береться з арени поточної глибини пошуку)
+    using Path = std::pmr::vector<char>;
 
     // Хеш та рівність для Path
     struct PathHash {
@@ -37,10 +54,66 @@ public:
         }
     };
 
+    using clock = std::chrono::steady_clock;
+
+    // Підказка для гравця щодо його часткового розв'язку
+    struct hint {
+        enum kind_t {
+            contradiction,  // поточний стан уже містить помилку або з нього немає рішення
+            black_cell,     // клітинки cells обов'язково чорні
+            white_cell,     // клітинки cells обов'язково належать острову
+            island,         // острів з рішення, узгодженого з поточним станом: cells - його клітинки
+            solved,         // стан уже є рішенням
+            timeout         // за відведений час нічого не знайдено
+        };
+        kind_t kind = timeout;
+        std::vector<cell> cells;
+        std::string reason;
+    };
+
     nurikabe_solver() = default;
 
-    // Запускає розв'язання задачі та повертає послідовність проміжних станів
-    std::vector<grid> solve(const grid initial);
+    // Запускає розв'язання задачі обраним алгоритмом та повертає послідовність проміжних станів
+    std::vector<grid> solve(const grid initial, engine mode = engine::search);
+
+    /*
+        Встановлює крайній термін для наступних розв'язань (std::nullopt - без обмеження).
+        Якщо термін минає під час пошуку, solve кидає std::runtime_error
+    */
+    void set_deadline(std::optional<clock::time_point> deadline) { deadline_ = deadline; }
+
+    /*
+        Підключає кеш розв'язків (nullptr - вимкнути). solve спершу шукає задачу в кеші,
+        а знайдений пошуком розв'язок записує туди. Кеш не належить розв'язувачу
+    */
+    void attach_cache(solution_cache *cache) { cache_ = cache; }
+
+    /*
+        Наступний крок для часткового стану partial (підказки, BLACK, FILLED, EMPTY - як у перевірці рішень).
+        Завершені гравцем острови вважаються розміщеними, далі по черзі від найдешевшого:
+        явні суперечності, локальні висновки (сусіди завершеного острова, вікна 2x2, недосяжні клітинки,
+        єдиний вихід чорної частини чи острова), і лише потім пошук з поточного стану, обмежений часом budget.
+        Острів із пошуку - це острів рішення, узгодженого з ходами гравця; для задачі з єдиним рішенням він вимушений.
+        Невірний розмір чи значення клітинки кидають std::runtime_error
+    */
+    hint next_hint(const grid &partial, std::chrono::milliseconds budget);
+
+    /*
+        Підключає запис дерева пошуку (nullptr - вимкнути). Записуються рішення, відсікання і відкати
+        перебору пар (engine::search), а також острови, відкинуті ще при переборі кандидатів (search і dlx),
+        у кільце потоку, який викликає solve. Запис не належить розв'язувачу
+    */
+    void attach_trace(search_trace *trace) { trace_ = trace; }
+
+    /*
+        Кеш островів-кандидатів пар (search і dlx): обмеження пам'яті і статистика влучань за всі розв'язання.
+        Записи живуть лише в межах одного розв'язання
+    */
+    void set_candidate_cache_limit(std::size_t max_bytes) { candidates_.set_limit(max_bytes); }
+    const candidate_cache::statistics &candidate_stats() const { return candidates_.stats(); }
+
+    // Перетворює назву алгоритму (search, dlx, sat) на значення engine, для невідомої назви кидає std::runtime_error
+    static engine parse_engine(const std::string &name);
 
 private:
     int rows_ = 0;
@@ -50,22 +123,88 @@ private:
     grid initial_grid_;     // початкова сітка
     std::vector<char> used_;                  // позначення використаних чисел (rows_*cols_)
     std::stack<Path>     path_stack_;         // стек для відновлення покрокового рішення
+    pair_graph pairs_;                        // граф можливих пар невикористаних підказок
+    std::optional<clock::time_point> deadline_;  // крайній термін розв'язання
+    solution_cache *cache_ = nullptr;         // спільний кеш розв'язків, якщо підключено
+    search_trace *trace_ = nullptr;           // запис дерева пошуку, якщо підключено
+    search_trace::ring *trace_ring_ = nullptr;  // кільце потоку поточного розв'язання
+    search_arena arena_;                      // пам'ять для тимчасових буферів кожної глибини рекурсії
+    candidate_cache candidates_;              // острови кожної пари, перебрані вище по дереву пошуку
+    mutable std::vector<int> visited_;        // мітки обходу чорної області (-1 - не відвідана)
+    mutable std::vector<int> flood_queue_;    // черга обходу flood
+    std::vector<unsigned> border_mark_;       // позначки сусідів острова для island_fits (номер перевірки)
+    std::vector<unsigned> seen_mark_;         // позначки обходу island_fits
+    unsigned fit_epoch_ = 0;
+    std::vector<int> fit_border_;            // сусіди острова, що перевіряється
+    std::vector<int> fit_queue_;             // черга обходу island_fits
+    bool local_exact_ = false;                // island_fits точно замінює глобальні перевірки в solve_recurse
+    std::vector<int> fixed_white_;            // клітинки, заповнені гравцем (лише для next_hint), острови мають їх зберегти
 
     // Зміщення по 4 напрямках: вверх, вниз, вліво, вправо
     static constexpr int DX_[4] = { -1, 1, 0, 0 };
     static constexpr int DY_[4] = {  0, 0,-1, 1 };
 
+    // Кидає std::runtime_error, якщо крайній термін уже минув
+    void check_deadline() const;
+
+    // Зв'язна область однокольорових клітинок: підказки і кількість різних порожніх сусідів
+    struct region {
+        std::vector<int> cells;
+        std::vector<int> liberties;
+        int clues = 0;
+        int clue_sum = 0;
+    };
+
+    // Області білих (підказки і FILLED) або чорних клітинок поточної сітки
+    std::vector<region> regions(bool black) const;
+
+    // Перевірки і локальні висновки next_hint; повертають false, якщо нічого не знайдено
+    bool find_contradiction(const std::vector<region> &white, hint &out) const;
+    bool find_forced_cells(const std::vector<region> &white, hint &out) const;
+
+    // Чи не торкається шлях заповненої гравцем клітинки, яка в нього не входить
+    bool keeps_fixed_white(const Path &path) const;
+
     // Основний рекурсивний метод для пошуку рішення
-    bool solve_recurse();
+    bool solve_recurse(int depth);
+
+    // Пошук через точне покриття: підказки - основні стовпці, пари - рядки, острови перебираються для обраного рядка
+    bool solve_dlx();
+
+    // Пошук через SAT: кодування в КНФ з лінивими розрізами для зв'язності островів і чорної області
+    bool solve_sat();
+
+    // Номер острова кожної клітинки в порядку кроків зі стеку шляхів (0 - клітинка не в острові)
+    std::vector<int> island_order() const;
+
+    // Заповнює стек шляхів островами з island_order так, щоб перший острів опинився на вершині
+    void push_island_order(const std::vector<int> &order);
 
     // Відновлення кроків розв'язку за шляхами зі стеку
     std::vector<grid> recover_step_by_step();
 
-    // Збирає координати ще не використаних чисел на сітці
-    void collect_numbers(std::vector<cell> &cells);
+    /*
+        Записує в result всі зв'язні шляхи розміру total_size між двома числами в обхід чорних клітинок.
+        Набір залежить лише від чорних клітинок сітки, тому його можна кешувати (див. pair_candidates)
+    */
+    void find_all_valid_paths(cell start, cell end, int total_size, std::pmr::vector<Path> &result);
 
-    // Повертає всі допустимі шляхи між двома числами, які можна з'єднати
-    std::vector<Path> find_all_valid_paths(cell start, cell end, int total_size);
+    /*
+        Острови пари e для поточного стану: з кешу, відкинувши ті, що зачіпають нові чорні клітинки,
+        або новим перебором. Острів, чиї пофарбовані сусіди замкнули б чорне вікно 2x2, не потрапляє в result;
+        з require_connected - також острів, що відрізав би частину чорних і порожніх клітинок (див. island_fits).
+        Кожен такий острів записується у trace як відсікання на глибині depth
+    */
+    void pair_candidates(int e, int depth, std::pmr::vector<Path> &result, bool require_connected);
+
+    /*
+        Локальна перевірка острова перед видачею: сусіди шляху стануть чорними, тож вікна 2x2 навколо них
+        перевіряються напряму. Якщо чорні і порожні клітинки були зв'язними, після розміщення вони зв'язні
+        тоді й лише тоді, коли зв'язні між собою сусіди острова; це спершу перевіряється обходом у вікні
+        навколо острова і лише за невдачі - обходом усієї сітки. Якщо острів не підходить, why - причина
+        (black_2x2 або black_split, ті ж коди, що й у відкатів пошуку)
+    */
+    bool island_fits(const Path &path, bool require_connected, search_trace::reason &why);
 
     // Обчислює мангетенську (найкоротшу) відстань між двома клітинками
     int manhattan(cell a, cell b) const;
@@ -76,18 +215,55 @@ private:
     // Перевіряє, чи координати виходять за межі поля
     bool out_of_bounds(int r, int c) const;
 
+    // Розміщує острів між f і c: заповнює шлях, фарбує сусідів у чорний і позначає підказки використаними
+    void place_island(const Path &path, cell f, cell c, std::pmr::vector<char> &painted);
+
+    // Прибирає острів, розміщений place_island, і обнуляє painted
+    void remove_island(const Path &path, cell f, cell c, std::pmr::vector<char> &painted);
+
     // Фарбує сусідні клітинки шляху в чорний колір
-    void paint_adjacent(const Path &path, std::vector<char> &painted);
+    void paint_adjacent(const Path &path, std::pmr::vector<char> &painted);
 
     // Перевіряє, чи всі чорні клітинки утворюють єдину зв'язну область
     bool is_black_area_connected() const;
 
-    // DFS-обхід, який рахує кількість зв'язаних чорних клітинок
-    int dfs_count_black(std::vector<char> &visited, cell c) const;
+    /*
+        Слабша, але монотонна перевірка: всі чорні клітинки мають лежати в одній компоненті чорних і порожніх.
+        Порожні кишені без чорних клітинок допускаються, бо їх ще може заповнити острів
+    */
+    bool can_black_area_connect() const;
+
+    // Чи є клітинка чорною або порожньою (може стати чорною)
+    bool black_or_empty(int id) const;
+
+    /*
+        Обхід у ширину від start по клітинках, для яких inside(id) істинне: кожна досяжна клітинка отримує мітку label
+        у comp (-1 - ще не відвідана). Повертає кількість позначених клітинок.
+        Спільний для перевірок чорної області і розрізів SAT, щоб зв'язність рахувалася в одному місці
+    */
+    template <class Inside>
+    int flood(int start, int label, std::vector<int> &comp, Inside inside) const {
+        std::vector<int> &queue = flood_queue_;
+        queue.assign(1, start);
+        comp[start] = label;
+        for (size_t qi = 0; qi < queue.size(); ++qi) {
+            int id = queue[qi], r = id/cols_, c = id%cols_;
+            for (int d = 0; d < 4; ++d) {
+                int nr = r + DX_[d], nc = c + DY_[d];
+                if (out_of_bounds(nr,nc)) continue;
+                int nid = nr*cols_ + nc;
+                if (comp[nid] < 0 && inside(nid)) {
+                    comp[nid] = label;
+                    queue.push_back(nid);
+                }
+            }
+        }
+        return static_cast<int>(queue.size());
+    }
 
     // Перевіряє, чи є в сітці чорний квадрат 2×2
     bool has_black_2x2_block() const;
 
     // Тимчасово заповнює всі порожні клітинки чорним і зберігає список для відновлення
-    void fill_spaces(std::vector<cell> &spaces);
+    void fill_spaces(std::pmr::vector<cell> &spaces);
 };
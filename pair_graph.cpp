@@ -0,0 +1,102 @@
+#include "pair_graph.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+void pair_graph::build(const std::vector<std::vector<int>> &grid) {
+    int rows = static_cast<int>(grid.size());
+    int cols = rows ? static_cast<int>(grid[0].size()) : 0;
+
+    // Збираємо підказки в порядку обходу сітки, тому для кожного ребра ca < cb
+    clues_.clear();
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c)
+            if (grid[r][c] > 0) clues_.emplace_back(r, c);
+
+    // Ребро існує, якщо острів розміру sum може дотягнутися від однієї підказки до іншої
+    edges_.clear();
+    for (int i = 0; i < clue_count(); ++i)
+        for (int j = i + 1; j < clue_count(); ++j) {
+            cell a = clues_[i], b = clues_[j];
+            int sum = grid[a.row][a.col] + grid[b.row][b.col];
+            int dist = std::abs(a.row - b.row) + std::abs(a.col - b.col);
+            if (sum > dist) edges_.push_back({i, j, a, b, sum, sum - dist});
+        }
+
+    /*
+        Ключ пріоритету обчислюється один раз: спершу пари з меншою кількістю "вільних" клітинок,
+        при рівності - пари з більшою сумою, бо вони сильніше зменшують зону пошуку
+    */
+    std::stable_sort(edges_.begin(), edges_.end(), [](const edge &p, const edge &q) {
+        if (p.free != q.free) return p.free < q.free;
+        return p.sum > q.sum;
+    });
+
+    int n = static_cast<int>(edges_.size());
+    incident_.resize(clue_count());
+    for (auto &list : incident_) list.clear();
+    degree_.assign(clue_count(), 0);
+    used_.assign(clue_count(), 0);
+    alive_.assign(n, 1);
+    next_.resize(n + 1);
+    prev_.resize(n + 1);
+    // Голова списку - окремий вузол з індексом n, тому список замкнений у кільце
+    for (int e = 0; e <= n; ++e) {
+        next_[e] = (e + 1) % (n + 1);
+        prev_[e] = (e + n) % (n + 1);
+    }
+
+    for (int e = 0; e < n; ++e) {
+        incident_[edges_[e].a].push_back(e);
+        incident_[edges_[e].b].push_back(e);
+        degree_[edges_[e].a]++;
+        degree_[edges_[e].b]++;
+    }
+
+    remaining_ = clue_count();
+    isolated_ = static_cast<int>(std::count(degree_.begin(), degree_.end(), 0));
+    removed_.clear();
+    marks_.clear();
+    selected_.clear();
+}
+
+void pair_graph::unlink(int e) {
+    alive_[e] = 0;
+    next_[prev_[e]] = next_[e];
+    prev_[next_[e]] = prev_[e];
+    for (int v : {edges_[e].a, edges_[e].b}) {
+        if (--degree_[v] == 0 && !used_[v]) isolated_++;
+    }
+    removed_.push_back(e);
+}
+
+void pair_graph::select(int e) {
+    const edge &pr = edges_[e];
+    marks_.push_back(static_cast<int>(removed_.size()));
+    selected_.push_back(e);
+    // Підказки пари стають використаними до вирізання, тому самі вони не рахуються ізольованими
+    used_[pr.a] = used_[pr.b] = 1;
+    remaining_ -= 2;
+    for (int v : {pr.a, pr.b})
+        for (int x : incident_[v])
+            if (alive_[x]) unlink(x);
+}
+
+void pair_graph::undo() {
+    int mark = marks_.back();
+    marks_.pop_back();
+    // Повертаємо ребра у зворотному порядку, тоді вказівники next_/prev_ відновлюються точно
+    while (static_cast<int>(removed_.size()) > mark) {
+        int e = removed_.back();
+        removed_.pop_back();
+        alive_[e] = 1;
+        next_[prev_[e]] = e;
+        prev_[next_[e]] = e;
+        for (int v : {edges_[e].a, edges_[e].b}) {
+            if (degree_[v]++ == 0 && !used_[v]) isolated_--;
+        }
+    }
+    const edge &pr = edges_[selected_.back()];
+    selected_.pop_back();
+    used_[pr.a] = used_[pr.b] = 0;
+    remaining_ += 2;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include "cell.hpp"
+
+/*
+    Граф можливих пар підказок, який живе весь час пошуку.
+    Вершини - клітинки з підказками, ребра - пари, які ще можна з'єднати островом (сума > манхетенська відстань).
+    Ребра один раз сортуються за пріоритетом і зберігаються у двозв'язному списку "живих" ребер:
+    вибір пари вирізає всі ребра її двох підказок, а undo() повертає їх у зворотному порядку
+*/
+class pair_graph {
+public:
+    static constexpr int END = -1;
+
+    struct edge {
+        int a, b;       // індекси підказок (a < b)
+        cell ca, cb;    // клітинки підказок (ca < cb)
+        int sum;        // розмір острова
+        int free;       // "вільні" клітинки: sum - manhattan(ca, cb)
+    };
+
+    // Будує граф для сітки: усі додатні значення вважаються невикористаними підказками
+    void build(const std::vector<std::vector<int>> &grid);
+
+    // Кількість підказок і кількість ще не використаних підказок
+    int clue_count() const { return static_cast<int>(clues_.size()); }
+    int remaining() const { return remaining_; }
+
+    // Загальна кількість ребер, включно з уже вирізаними (номер ребра не змінюється під час пошуку)
+    int edge_count() const { return static_cast<int>(edges_.size()); }
+
+    // Чи є невикористана підказка, для якої не залишилося жодної пари
+    bool has_isolated() const { return isolated_ > 0; }
+
+    // Кількість живих ребер підказки
+    int degree(int clue) const { return degree_[clue]; }
+
+    // Обхід живих ребер від найпріоритетнішого
+    int first() const { return next(head()); }
+    int next(int e) const { return next_[e] == head() ? END : next_[e]; }
+    const edge &at(int e) const { return edges_[e]; }
+
+    // Позначає пару як використану: вирізає всі живі ребра обох її підказок
+    void select(int e);
+
+    // Скасовує останній select
+    void undo();
+
+private:
+    std::vector<cell> clues_;
+    std::vector<edge> edges_;
+    std::vector<std::vector<int>> incident_;  // ребра кожної підказки
+    std::vector<int> degree_;
+    std::vector<char> used_;
+    std::vector<char> alive_;
+    std::vector<int> next_, prev_;            // двозв'язний список живих ребер, вузол edges_.size() - голова
+    std::vector<int> removed_;                // журнал вирізаних ребер для undo
+    std::vector<int> marks_;                  // розмір журналу перед кожним select
+    std::vector<int> selected_;               // обрані ребра у порядку виклику select
+    int remaining_ = 0;
+    int isolated_ = 0;
+
+    int head() const { return static_cast<int>(edges_.size()); }
+
+    // Вирізає ребро зі списку та зменшує степені його підказок
+    void unlink(int e);
+};
@@ -0,0 +1,182 @@
+#include "puzzle_corpus.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static constexpr char MAGIC[8] = {'N', 'K', 'C', 'O', 'R', 'P', 'S', '1'};
+static constexpr std::uint32_t VERSION = 1;
+static constexpr std::size_t HEADER_SIZE = 32;
+static constexpr std::size_t BOARD_HEADER_SIZE = 8;
+static constexpr std::uint8_t HAS_SOLUTION = 1;
+
+static std::uint16_t get_u16(const std::uint8_t *p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+static std::uint32_t get_u32(const std::uint8_t *p) {
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+}
+
+static std::uint64_t get_u64(const std::uint8_t *p) {
+    return std::uint64_t(get_u32(p)) | (std::uint64_t(get_u32(p + 4)) << 32);
+}
+
+static void put_le(std::string &buf, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) buf.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+puzzle_corpus::grid puzzle_corpus::board_view::to_grid() const {
+    grid g(rows, std::vector<int>(cols));
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c)
+            g[r][c] = at(r, c);
+    return g;
+}
+
+puzzle_corpus::puzzle_corpus(const std::string &path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Не вдалося відкрити корпус " + path + ": " + std::strerror(errno));
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) < 0 || static_cast<std::size_t>(st.st_size) < HEADER_SIZE) {
+        ::close(fd_);
+        throw std::runtime_error("Файл " + path + " не є корпусом задач");
+    }
+    map_size_ = static_cast<std::size_t>(st.st_size);
+    void *map = ::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error("Не вдалося відобразити корпус " + path + ": " + std::strerror(errno));
+    }
+    map_ = static_cast<const std::uint8_t *>(map);
+
+    // Перевіряємо заголовок і те, що індекс повністю лежить у файлі
+    std::uint64_t count = get_u64(map_ + 16);
+    std::uint64_t index = get_u64(map_ + 24);
+    if (std::memcmp(map_, MAGIC, sizeof(MAGIC)) != 0 || get_u32(map_ + 8) != VERSION ||
+        index < HEADER_SIZE || index > map_size_ || count > (map_size_ - index) / 8) {
+        ::munmap(const_cast<std::uint8_t *>(map_), map_size_);
+        ::close(fd_);
+        throw std::runtime_error("Файл " + path + " не є корпусом задач або пошкоджений");
+    }
+    count_ = static_cast<std::size_t>(count);
+    index_ = map_ + index;
+}
+
+puzzle_corpus::~puzzle_corpus() {
+    if (map_) ::munmap(const_cast<std::uint8_t *>(map_), map_size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+puzzle_corpus::board_view puzzle_corpus::board(std::size_t index) const {
+    if (index >= count_) {
+        throw std::runtime_error("Немає задачі з номером " + std::to_string(index) + " (у корпусі " +
+                                 std::to_string(count_) + ")");
+    }
+    std::uint64_t offset = get_u64(index_ + 8 * index);
+    if (offset > map_size_ - BOARD_HEADER_SIZE) {
+        throw std::runtime_error("Пошкоджений запис задачі " + std::to_string(index));
+    }
+    const std::uint8_t *p = map_ + offset;
+    board_view v;
+    v.rows = get_u16(p);
+    v.cols = get_u16(p + 2);
+    std::size_t cells = static_cast<std::size_t>(v.rows) * v.cols;
+    std::size_t bytes = (p[4] & HAS_SOLUTION) ? 2 * cells : cells;
+    // Запис не повинен виходити за межі області задач
+    if (bytes > map_size_ - offset - BOARD_HEADER_SIZE) {
+        throw std::runtime_error("Пошкоджений запис задачі " + std::to_string(index));
+    }
+    v.clues = p + BOARD_HEADER_SIZE;
+    if (p[4] & HAS_SOLUTION) v.solution = v.clues + cells;
+    return v;
+}
+
+corpus_writer::corpus_writer(const std::string &path) : out_(path, std::ios::binary | std::ios::trunc), path_(path) {
+    if (!out_) {
+        throw std::runtime_error("Не вдалося створити корпус " + path);
+    }
+    // Місце під заголовок; справжні значення з'являться у finish()
+    std::string header(HEADER_SIZE, '\0');
+    out_.write(header.data(), header.size());
+    position_ = HEADER_SIZE;
+}
+
+corpus_writer::~corpus_writer() {
+    if (!finished_) {
+        // Заголовок ще нульовий, тож частковий файл і так не відкрився б; прибираємо його
+        out_.close();
+        std::remove(path_.c_str());
+    }
+}
+
+void corpus_writer::add(const grid &puzzle, const grid *solution) {
+    int rows = static_cast<int>(puzzle.size());
+    int cols = rows ? static_cast<int>(puzzle[0].size()) : 0;
+    if (rows <= 0 || cols <= 0 || rows > 0xFFFF || cols > 0xFFFF) {
+        throw std::runtime_error("Невірний розмір задачі для корпусу");
+    }
+    // Довжина запису визначається заголовком rows*cols: інша кількість клітинок зсунула б усі наступні записи
+    for (const auto &row : puzzle) {
+        if (static_cast<int>(row.size()) != cols) {
+            throw std::runtime_error("Рядки задачі мають різну довжину");
+        }
+    }
+    if (solution) {
+        bool same = static_cast<int>(solution->size()) == rows;
+        for (int r = 0; same && r < rows; ++r) same = static_cast<int>((*solution)[r].size()) == cols;
+        if (!same) {
+            throw std::runtime_error("Розмір розв'язку не збігається з розміром задачі");
+        }
+    }
+
+    std::string record;
+    record.reserve(BOARD_HEADER_SIZE + 2 * rows * cols);
+    put_le(record, rows, 2);
+    put_le(record, cols, 2);
+    put_le(record, solution ? HAS_SOLUTION : 0, 1);
+    put_le(record, 0, 3);
+    for (const auto &row : puzzle) {
+        for (int v : row) {
+            if (v < 0 || v > 0xFF) {
+                throw std::runtime_error("Підказка " + std::to_string(v) + " не вміщується в один байт");
+            }
+            record.push_back(static_cast<char>(v));
+        }
+    }
+    if (solution) {
+        // Усе, що не чорне (підказки, FILLED), - клітинки островів
+        for (const auto &row : *solution)
+            for (int v : row) record.push_back(static_cast<char>(v == -1 ? 0 : 1));
+    }
+
+    offsets_.push_back(position_);
+    out_.write(record.data(), record.size());
+    position_ += record.size();
+}
+
+void corpus_writer::finish() {
+    finished_ = true;
+    std::string index;
+    index.reserve(8 * offsets_.size());
+    for (std::uint64_t off : offsets_) put_le(index, off, 8);
+    out_.write(index.data(), index.size());
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    put_le(header, VERSION, 4);
+    put_le(header, 0, 4);
+    put_le(header, offsets_.size(), 8);
+    put_le(header, position_, 8);
+    out_.seekp(0);
+    out_.write(header.data(), header.size());
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("Помилка запису корпусу " + path_);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Двійковий корпус задач для пакетної обробки і бенчмарків.
+
+    Формат файлу (усі числа little-endian):
+      заголовок   "NKCORPS1", u32 версія, u32 прапорці, u64 кількість задач, u64 зсув індексу
+      задачі      u16 rows, u16 cols, u8 прапорці (біт 0 - є розв'язок), u8[3] резерв,
+                  rows*cols байтів підказок (0 - порожня клітинка),
+                  за наявності розв'язку - ще rows*cols байтів (1 - клітинка острова, 0 - чорна)
+      індекс      u64 зсув кожної задачі від початку файлу
+
+    Читач відображає файл у пам'ять і віддає задачі як представлення без копіювання,
+    тому обробники можуть ділити корпус за діапазонами індексів без жодного розбору тексту
+*/
+class puzzle_corpus {
+public:
+    using grid = std::vector<std::vector<int>>;
+
+    // Представлення однієї задачі; вказівники дійсні, доки існує puzzle_corpus
+    struct board_view {
+        int rows = 0;
+        int cols = 0;
+        const std::uint8_t *clues = nullptr;
+        const std::uint8_t *solution = nullptr;    // nullptr, якщо розв'язок не збережено
+
+        int at(int r, int c) const { return clues[r * cols + c]; }
+        bool has_solution() const { return solution != nullptr; }
+
+        // Копія задачі у форматі розв'язувача
+        grid to_grid() const;
+    };
+
+    // Відкриває і відображає корпус у пам'ять, у разі помилки кидає std::runtime_error
+    explicit puzzle_corpus(const std::string &path);
+    ~puzzle_corpus();
+
+    puzzle_corpus(const puzzle_corpus &) = delete;
+    puzzle_corpus &operator=(const puzzle_corpus &) = delete;
+
+    std::size_t size() const { return count_; }
+
+    // Задача з номером index; index поза межами корпусу чи пошкоджений запис кидають std::runtime_error
+    board_view board(std::size_t index) const;
+
+private:
+    int fd_ = -1;
+    const std::uint8_t *map_ = nullptr;
+    std::size_t map_size_ = 0;
+    std::size_t count_ = 0;
+    const std::uint8_t *index_ = nullptr;
+};
+
+/*
+    Послідовний запис корпусу: задачі пишуться одразу у файл, у пам'яті тримаються лише зсуви,
+    індекс і остаточний заголовок записуються в finish().
+    Без finish() (наприклад, при виході через виняток) деструктор видаляє незавершений файл:
+    коректний заголовок отримує лише повністю записаний корпус
+*/
+class corpus_writer {
+public:
+    using grid = puzzle_corpus::grid;
+
+    // Створює файл корпусу, у разі помилки кидає std::runtime_error
+    explicit corpus_writer(const std::string &path);
+    ~corpus_writer();
+
+    /*
+        Додає задачу і, за наявності, її розв'язок (сітка розв'язувача: підказки і FILLED - острів).
+        Підказка, більша за 255, розмір понад 65535, рядки різної довжини чи розв'язок іншого розміру
+        кидають std::runtime_error
+    */
+    void add(const grid &puzzle, const grid *solution = nullptr);
+
+    // Записує індекс і заголовок; після цього файл готовий до читання
+    void finish();
+
+    std::size_t size() const { return offsets_.size(); }
+
+private:
+    std::ofstream out_;
+    std::string path_;
+    std::vector<std::uint64_t> offsets_;
+    std::uint64_t position_ = 0;
+    bool finished_ = false;
+};
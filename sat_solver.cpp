@@ -0,0 +1,354 @@
+#include "sat_solver.hpp"
+#include <algorithm>
+
+// Послідовність Луби 1,1,2,1,1,2,4,... для тривалості перезапусків
+static long long luby(int i) {
+    long long size = 1;
+    int seq = 0;
+    while (size < i + 1) {
+        ++seq;
+        size = 2 * size + 1;
+    }
+    long long x = i;
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        --seq;
+        x = x % size;
+    }
+    return 1LL << seq;
+}
+
+int sat_solver::new_var() {
+    int v = var_count();
+    assign_.push_back(UNDEF_);
+    model_.push_back(UNDEF_);
+    level_.push_back(0);
+    reason_.push_back(-1);
+    // За замовчуванням змінна отримує значення "хибно"
+    phase_.push_back(1);
+    seen_.push_back(0);
+    activity_.push_back(0.0);
+    heap_index_.push_back(-1);
+    watches_.emplace_back();
+    watches_.emplace_back();
+    heap_insert(v);
+    return v;
+}
+
+bool sat_solver::add_clause(std::vector<lit> lits) {
+    if (unsat_) return false;
+    cancel_until(0);
+
+    // Прибираємо дублікати, тавтології, хибні на нульовому рівні літерали і вже виконані клаузи
+    std::sort(lits.begin(), lits.end());
+    std::vector<lit> kept;
+    for (size_t i = 0; i < lits.size(); ++i) {
+        lit p = lits[i];
+        if (i > 0 && p == lits[i - 1]) continue;
+        if (i > 0 && p == (lits[i - 1] ^ 1)) return true;
+        if (value(p) == TRUE_) return true;
+        if (value(p) == FALSE_) continue;
+        kept.push_back(p);
+    }
+
+    if (kept.empty()) {
+        unsat_ = true;
+        return false;
+    }
+    if (kept.size() == 1) {
+        enqueue(kept[0], -1);
+        if (propagate() >= 0) unsat_ = true;
+        return !unsat_;
+    }
+    attach_clause(kept, false);
+    return true;
+}
+
+int sat_solver::attach_clause(const std::vector<lit> &lits, bool learnt) {
+    int ci = static_cast<int>(start_.size());
+    start_.push_back(static_cast<int>(pool_.size()));
+    size_.push_back(static_cast<int>(lits.size()));
+    learnt_.push_back(learnt);
+    deleted_.push_back(0);
+    pool_.insert(pool_.end(), lits.begin(), lits.end());
+    watches_[lits[0]].push_back(ci);
+    watches_[lits[1]].push_back(ci);
+    if (learnt) learnt_count_++;
+    return ci;
+}
+
+void sat_solver::enqueue(lit p, int reason) {
+    int v = p >> 1;
+    assign_[v] = static_cast<int8_t>(!(p & 1));
+    level_[v] = decision_level();
+    reason_[v] = reason;
+    trail_.push_back(p);
+}
+
+// Поширення одиничних клаузів; повертає номер конфліктного клаузу або -1
+int sat_solver::propagate() {
+    while (qhead_ < trail_.size()) {
+        lit falsified = trail_[qhead_++] ^ 1;
+        stats_.propagations++;
+        std::vector<int> &ws = watches_[falsified];
+        size_t i = 0, j = 0;
+        while (i < ws.size()) {
+            int ci = ws[i++];
+            // Видалені клаузи прибираються зі списків спостереження ліниво
+            if (deleted_[ci]) continue;
+            lit *c = &pool_[start_[ci]];
+            int n = size_[ci];
+            // Хибний літерал тримаємо на позиції 1
+            if (c[0] == falsified) std::swap(c[0], c[1]);
+            if (value(c[0]) == TRUE_) {
+                ws[j++] = ci;
+                continue;
+            }
+            // Шукаємо новий літерал для спостереження
+            bool moved = false;
+            for (int k = 2; k < n; ++k) {
+                if (value(c[k]) != FALSE_) {
+                    std::swap(c[1], c[k]);
+                    watches_[c[1]].push_back(ci);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            ws[j++] = ci;
+            if (value(c[0]) == FALSE_) {
+                // Конфлікт: дописуємо решту списку і зупиняємо поширення
+                while (i < ws.size()) ws[j++] = ws[i++];
+                ws.resize(j);
+                qhead_ = trail_.size();
+                return ci;
+            }
+            enqueue(c[0], ci);
+        }
+        ws.resize(j);
+    }
+    return -1;
+}
+
+// Літерал надлишковий у вивченому клаузі, якщо всі інші літерали його причини вже є в клаузі
+bool sat_solver::redundant(lit p) const {
+    int r = reason_[p >> 1];
+    if (r < 0) return false;
+    const lit *c = &pool_[start_[r]];
+    for (int k = 1; k < size_[r]; ++k) {
+        int v = c[k] >> 1;
+        if (!seen_[v] && level_[v] > 0) return false;
+    }
+    return true;
+}
+
+void sat_solver::analyze(int conflict, std::vector<lit> &learnt, int &backtrack_level) {
+    learnt.clear();
+    learnt.push_back(-1);
+    int counter = 0;
+    lit p = -1;
+    int idx = static_cast<int>(trail_.size()) - 1;
+    int ci = conflict;
+
+    do {
+        const lit *c = &pool_[start_[ci]];
+        // Для клаузу-причини пропускаємо сам виведений літерал (він на позиції 0)
+        for (int k = (p == -1 ? 0 : 1); k < size_[ci]; ++k) {
+            lit q = c[k];
+            int v = q >> 1;
+            if (seen_[v] || level_[v] == 0) continue;
+            seen_[v] = 1;
+            bump_var(v);
+            if (level_[v] >= decision_level()) counter++;
+            else learnt.push_back(q);
+        }
+        // Наступний позначений літерал на трейлі
+        while (!seen_[trail_[idx] >> 1]) idx--;
+        p = trail_[idx--];
+        ci = reason_[p >> 1];
+        seen_[p >> 1] = 0;
+        counter--;
+    } while (counter > 0);
+    learnt[0] = p ^ 1;
+
+    // Локальна мінімізація і очищення позначок
+    std::vector<lit> all(learnt.begin() + 1, learnt.end());
+    size_t j = 1;
+    for (size_t i = 1; i < learnt.size(); ++i) {
+        if (!redundant(learnt[i])) learnt[j++] = learnt[i];
+    }
+    learnt.resize(j);
+    for (lit q : all) seen_[q >> 1] = 0;
+
+    // Рівень повернення - найбільший рівень серед решти літералів, цей літерал стає другим спостережуваним
+    backtrack_level = 0;
+    if (learnt.size() > 1) {
+        size_t max_i = 1;
+        for (size_t i = 2; i < learnt.size(); ++i) {
+            if (level_[learnt[i] >> 1] > level_[learnt[max_i] >> 1]) max_i = i;
+        }
+        std::swap(learnt[1], learnt[max_i]);
+        backtrack_level = level_[learnt[1] >> 1];
+    }
+}
+
+void sat_solver::cancel_until(int level) {
+    if (decision_level() <= level) return;
+    for (int i = static_cast<int>(trail_.size()) - 1; i >= trail_lim_[level]; --i) {
+        int v = trail_[i] >> 1;
+        phase_[v] = static_cast<char>(trail_[i] & 1);
+        assign_[v] = UNDEF_;
+        reason_[v] = -1;
+        if (heap_index_[v] < 0) heap_insert(v);
+    }
+    trail_.resize(trail_lim_[level]);
+    trail_lim_.resize(level);
+    qhead_ = trail_.size();
+}
+
+bool sat_solver::locked(int ci) const {
+    lit p = pool_[start_[ci]];
+    return value(p) == TRUE_ && reason_[p >> 1] == ci;
+}
+
+// Видаляємо половину найдовших вивчених клаузів, окрім тих, що зараз є причинами
+void sat_solver::reduce_db() {
+    std::vector<int> cand;
+    for (int ci = 0; ci < static_cast<int>(start_.size()); ++ci) {
+        if (learnt_[ci] && !deleted_[ci] && size_[ci] > 2 && !locked(ci)) cand.push_back(ci);
+    }
+    std::sort(cand.begin(), cand.end(), [&](int a, int b) { return size_[a] > size_[b]; });
+    for (size_t i = 0; i < cand.size() / 2; ++i) {
+        deleted_[cand[i]] = 1;
+        learnt_count_--;
+    }
+    max_learnts_ *= 1.1;
+}
+
+// Повертає 1 - модель знайдена, 0 - формула суперечлива, -1 - вичерпано ліміт конфліктів (перезапуск)
+int sat_solver::search(long long conflict_budget) {
+    std::vector<lit> learnt;
+    long long conflicts = 0;
+    for (;;) {
+        int confl = propagate();
+        if (confl >= 0) {
+            stats_.conflicts++;
+            conflicts++;
+            if (decision_level() == 0) return 0;
+            int bt;
+            analyze(confl, learnt, bt);
+            cancel_until(bt);
+            if (learnt.size() == 1) {
+                enqueue(learnt[0], -1);
+            } else {
+                int ci = attach_clause(learnt, true);
+                enqueue(learnt[0], ci);
+            }
+            var_inc_ /= 0.95;
+            if (interrupt_ && stats_.conflicts % 256 == 0) interrupt_();
+            if (conflicts >= conflict_budget) {
+                cancel_until(0);
+                return -1;
+            }
+            continue;
+        }
+
+        if (learnt_count_ - static_cast<int>(trail_.size()) >= max_learnts_) reduce_db();
+
+        // Рішення: незначена змінна з найбільшою активністю і збереженою фазою
+        int v = -1;
+        while (!heap_.empty()) {
+            int cand = heap_pop();
+            if (assign_[cand] == UNDEF_) {
+                v = cand;
+                break;
+            }
+        }
+        if (v < 0) return 1;
+        stats_.decisions++;
+        trail_lim_.push_back(static_cast<int>(trail_.size()));
+        enqueue(phase_[v] ? neg(v) : pos(v), -1);
+    }
+}
+
+bool sat_solver::solve() {
+    if (unsat_) return false;
+    cancel_until(0);
+    if (propagate() >= 0) {
+        unsat_ = true;
+        return false;
+    }
+    max_learnts_ = std::max(5000.0, static_cast<double>(start_.size()) / 3.0);
+
+    for (int restart = 0;; ++restart) {
+        int res = search(luby(restart) * 100);
+        if (res == 1) {
+            model_ = assign_;
+            cancel_until(0);
+            return true;
+        }
+        if (res == 0) {
+            unsat_ = true;
+            return false;
+        }
+        stats_.restarts++;
+    }
+}
+
+void sat_solver::bump_var(int v) {
+    activity_[v] += var_inc_;
+    if (activity_[v] > 1e100) {
+        for (double &a : activity_) a *= 1e-100;
+        var_inc_ *= 1e-100;
+    }
+    if (heap_index_[v] >= 0) heap_up(heap_index_[v]);
+}
+
+void sat_solver::heap_up(int i) {
+    int v = heap_[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_less(v, heap_[parent])) break;
+        heap_[i] = heap_[parent];
+        heap_index_[heap_[i]] = i;
+        i = parent;
+    }
+    heap_[i] = v;
+    heap_index_[v] = i;
+}
+
+void sat_solver::heap_down(int i) {
+    int v = heap_[i];
+    int n = static_cast<int>(heap_.size());
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && heap_less(heap_[child + 1], heap_[child])) child++;
+        if (!heap_less(heap_[child], v)) break;
+        heap_[i] = heap_[child];
+        heap_index_[heap_[i]] = i;
+        i = child;
+    }
+    heap_[i] = v;
+    heap_index_[v] = i;
+}
+
+void sat_solver::heap_insert(int v) {
+    heap_.push_back(v);
+    heap_index_[v] = static_cast<int>(heap_.size()) - 1;
+    heap_up(heap_index_[v]);
+}
+
+int sat_solver::heap_pop() {
+    int top = heap_[0];
+    heap_index_[top] = -1;
+    int last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        heap_[0] = last;
+        heap_index_[last] = 0;
+        heap_down(0);
+    }
+    return top;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+/*
+    Мінімальний CDCL SAT-розв'язувач без зовнішніх залежностей:
+    два спостережувані літерали на клауз, навчання за першою точкою домінування (1UIP),
+    евристика VSIDS з купою за активністю, збереження фаз і перезапуски за послідовністю Луби.
+    Розв'язувач інкрементальний: між викликами solve() можна додавати нові клаузи,
+    вивчені клаузи при цьому зберігаються
+*/
+class sat_solver {
+public:
+    // Літерал змінної v: 2*v - позитивний, 2*v+1 - заперечений
+    using lit = int;
+    static lit pos(int v) { return 2 * v; }
+    static lit neg(int v) { return 2 * v + 1; }
+
+    struct statistics {
+        long long decisions = 0;
+        long long propagations = 0;
+        long long conflicts = 0;
+        long long restarts = 0;
+    };
+
+    // Створює нову змінну і повертає її номер
+    int new_var();
+    int var_count() const { return static_cast<int>(assign_.size()); }
+
+    // Додає клауз (диз'юнкцію літералів). Повертає false, якщо формула стала суперечливою
+    bool add_clause(std::vector<lit> lits);
+
+    // Шукає виконуючий набір. true - знайдено (значення доступні через model_value)
+    bool solve();
+
+    // Значення змінної в останній знайденій моделі
+    bool model_value(int v) const { return model_[v] == 1; }
+
+    const statistics &stats() const { return stats_; }
+
+    /*
+        Функція, яку розв'язувач періодично викликає під час пошуку (кожні кілька сотень конфліктів).
+        Вона може кинути виняток, щоб перервати пошук; після цього розв'язувач не слід використовувати
+    */
+    void set_interrupt_hook(std::function<void()> hook) { interrupt_ = std::move(hook); }
+
+private:
+    static constexpr int8_t FALSE_ = 0, TRUE_ = 1, UNDEF_ = 2;
+
+    // Клаузи зберігаються підряд в одному пулі літералів
+    std::vector<lit> pool_;
+    std::vector<int> start_, size_;
+    std::vector<char> learnt_, deleted_;
+    int learnt_count_ = 0;
+    double max_learnts_ = 0;
+
+    std::vector<std::vector<int>> watches_;   // watches_[l] - клаузи, в яких l спостерігається
+    std::vector<int8_t> assign_, model_;
+    std::vector<int> level_, reason_;
+    std::vector<char> phase_, seen_;
+    std::vector<lit> trail_;
+    std::vector<int> trail_lim_;
+    std::size_t qhead_ = 0;
+    bool unsat_ = false;
+
+    // VSIDS
+    std::vector<double> activity_;
+    double var_inc_ = 1.0;
+    std::vector<int> heap_, heap_index_;
+
+    statistics stats_;
+    std::function<void()> interrupt_;
+
+    int8_t value(lit p) const {
+        int8_t a = assign_[p >> 1];
+        return a == UNDEF_ ? UNDEF_ : static_cast<int8_t>(a ^ (p & 1));
+    }
+    int decision_level() const { return static_cast<int>(trail_lim_.size()); }
+
+    int attach_clause(const std::vector<lit> &lits, bool learnt);
+    void enqueue(lit p, int reason);
+    int propagate();
+    void analyze(int conflict, std::vector<lit> &learnt, int &backtrack_level);
+    bool redundant(lit p) const;
+    void cancel_until(int level);
+    int search(long long conflict_budget);
+    void reduce_db();
+    bool locked(int ci) const;
+
+    void bump_var(int v);
+    void heap_up(int i);
+    void heap_down(int i);
+    void heap_insert(int v);
+    int heap_pop();
+    bool heap_less(int a, int b) const { return activity_[a] > activity_[b]; }
+};
@@ -0,0 +1,45 @@
+#include "search_arena.hpp"
+#include <algorithm>
+#include <memory>
+
+depth_arena::depth_arena(std::size_t first_block) : next_size_(first_block) {}
+
+// Повертаємося на початок першого блока, самі блоки залишаються у власності області
+void depth_arena::reset() noexcept {
+    current_ = 0;
+    offset_ = 0;
+}
+
+void *depth_arena::do_allocate(std::size_t bytes, std::size_t align) {
+    // Шукаємо серед уже наявних блоків той, у якому вистачає місця з урахуванням вирівнювання
+    while (current_ < blocks_.size()) {
+        block &b = blocks_[current_];
+        void *p = b.data.get() + offset_;
+        std::size_t space = b.size - offset_;
+        if (std::align(align, bytes, p, space)) {
+            offset_ = b.size - space + bytes;
+            return p;
+        }
+        ++current_;
+        offset_ = 0;
+    }
+
+    // Місця немає - додаємо новий блок, розмір кожного наступного подвоюється
+    std::size_t size = std::max(next_size_, bytes + align);
+    next_size_ = size * 2;
+    blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    capacity_ += size;
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return do_allocate(bytes, align);
+}
+
+search_arena::depth_scratch &search_arena::at_depth(int depth) {
+    while (static_cast<int>(depths_.size()) <= depth) {
+        depths_.push_back(std::make_unique<depth_scratch>());
+    }
+    depth_scratch &s = *depths_[depth];
+    s.frame.reset();
+    s.candidates.reset();
+    return s;
+}
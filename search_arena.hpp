@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+/*
+    Монотонна область пам'яті для одного рівня рекурсії.
+    Виділення - просте зсування вказівника, звільнення окремих блоків не відбувається.
+    reset() лише повертає вказівник на початок, тому всі блоки, отримані під час "розігріву",
+    перевикористовуються і наступні виділення з цієї області не звертаються до malloc
+*/
+class depth_arena : public std::pmr::memory_resource {
+public:
+    explicit depth_arena(std::size_t first_block = 16 * 1024);
+
+    depth_arena(const depth_arena &) = delete;
+    depth_arena &operator=(const depth_arena &) = delete;
+
+    // Скидає область до початку, зберігаючи всі виділені блоки
+    void reset() noexcept;
+
+    // Загальний обсяг блоків, якими володіє область
+    std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    struct block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::vector<block> blocks_;     // блоки в порядку виділення
+    std::size_t current_ = 0;       // індекс блока, з якого зараз виділяємо
+    std::size_t offset_ = 0;        // зсув всередині поточного блока
+    std::size_t next_size_;         // розмір наступного нового блока
+    std::size_t capacity_ = 0;
+
+    void *do_allocate(std::size_t bytes, std::size_t align) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/*
+    Набір арен розв'язувача: дві області на кожну глибину рекурсії
+    (frame - для даних вузла, candidates - для шляхів поточної пари)
+    і дві області, між якими чергуються рівні перебору шляхів.
+    Арени покривають лише тимчасові дані пошуку; результати, що переживають вузол (стек шляхів, кроки рішення,
+    кеш кандидатів), виділяються звичайно
+*/
+class search_arena {
+public:
+    struct depth_scratch {
+        depth_arena frame;
+        depth_arena candidates;
+    };
+
+    // Повертає скинуті області для вказаної глибини, створюючи їх за потреби
+    depth_scratch &at_depth(int depth);
+
+    // Область для рівня перебору шляхів (0 або 1)
+    depth_arena &level(int parity) { return level_[parity & 1]; }
+
+private:
+    // unique_ptr, бо контейнери тримають адреси областей, і вони не повинні переміщатися
+    std::vector<std::unique_ptr<depth_scratch>> depths_;
+    depth_arena level_[2];
+};
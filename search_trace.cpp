@@ -0,0 +1,215 @@
+#include "search_trace.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+
+static constexpr char MAGIC[8] = {'N', 'K', 'T', 'R', 'A', 'C', 'E', '1'};
+static constexpr std::uint32_t VERSION = 1;
+static constexpr std::size_t HEADER_SIZE = 24;
+static constexpr std::size_t EVENT_SIZE = 24;
+
+static const char *const KIND_NAMES[] = {"рішення", "відкат", "відсікання", "розв'язок"};
+static const char *const REASON_NAMES[] = {
+    "-", "блок 2x2", "розрив чорної області", "підказка без пари", "пари підказки вичерпано", "блок 2x2 у кінці"
+};
+
+static void put_le(std::string &buf, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) buf.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static std::uint64_t get_le(const unsigned char *p, int bytes) {
+    std::uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+search_trace::ring::ring(std::size_t capacity, std::uint16_t thread, std::chrono::steady_clock::time_point origin)
+    : events_(capacity), mask_(capacity - 1), thread_(thread), origin_(origin) {}
+
+std::vector<search_trace::event> search_trace::ring::snapshot() const {
+    std::uint64_t head = head_.load(std::memory_order_acquire);
+    std::uint64_t size = std::min<std::uint64_t>(head, events_.size());
+    std::vector<event> res;
+    res.reserve(size);
+    for (std::uint64_t i = head - size; i < head; ++i) res.push_back(events_[i & mask_]);
+    return res;
+}
+
+search_trace::search_trace(std::size_t ring_capacity) : origin_(std::chrono::steady_clock::now()) {
+    capacity_ = 1;
+    while (capacity_ < ring_capacity) capacity_ <<= 1;
+}
+
+search_trace::ring &search_trace::local() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::thread::id self = std::this_thread::get_id();
+    for (std::size_t i = 0; i < owners_.size(); ++i) {
+        if (owners_[i] == self) return *rings_[i];
+    }
+    owners_.push_back(self);
+    rings_.push_back(std::make_unique<ring>(capacity_, static_cast<std::uint16_t>(rings_.size()), origin_));
+    return *rings_.back();
+}
+
+std::vector<search_trace::event> search_trace::events() const {
+    std::vector<event> all;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &r : rings_) {
+            std::vector<event> part = r->snapshot();
+            all.insert(all.end(), part.begin(), part.end());
+        }
+    }
+    // Порядок усередині потоку зберігається, потоки перемежовуються за часом
+    std::stable_sort(all.begin(), all.end(), [](const event &a, const event &b) { return a.ns < b.ns; });
+    return all;
+}
+
+void search_trace::write_chrome(const std::string &path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Не вдалося створити файл " + path);
+    }
+    /*
+        Рішення відкривають проміжок (B), відкат його закриває (E), решта подій - миттєві (i).
+        Проміжки, відкриті на шляху до розв'язку, залишаються відкритими до кінця запису
+    */
+    std::string buf = "{\"traceEvents\":[\n";
+    char line[256];
+    bool first = true;
+    for (const event &e : events()) {
+        const char *ph = e.kind == decision ? "B" : e.kind == undo ? "E" : "i";
+        int n = std::snprintf(line, sizeof(line),
+                              "%s{\"name\":\"%s %d\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u%s"
+                              ",\"args\":{\"depth\":%u,\"candidate\":%d,\"size\":%u,\"reason\":\"%s\"}}",
+                              first ? "" : ",\n", e.kind == decision || e.kind == undo ? "пара" : KIND_NAMES[e.kind],
+                              e.pair, ph, e.ns / 1000.0, e.thread, e.kind == prune || e.kind == solution ? ",\"s\":\"t\"" : "",
+                              e.depth, e.candidate, e.size, REASON_NAMES[e.reason]);
+        buf.append(line, n);
+        first = false;
+    }
+    buf += "\n]}\n";
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    if (!out) {
+        throw std::runtime_error("Помилка запису " + path);
+    }
+}
+
+void search_trace::write_binary(const std::string &path) const {
+    std::vector<event> all = events();
+    std::string buf(MAGIC, sizeof(MAGIC));
+    put_le(buf, VERSION, 4);
+    put_le(buf, EVENT_SIZE, 4);
+    put_le(buf, all.size(), 8);
+    buf.reserve(HEADER_SIZE + all.size() * EVENT_SIZE);
+    for (const event &e : all) {
+        put_le(buf, e.ns, 8);
+        put_le(buf, static_cast<std::uint32_t>(e.pair), 4);
+        put_le(buf, static_cast<std::uint32_t>(e.candidate), 4);
+        put_le(buf, e.depth, 2);
+        put_le(buf, e.size, 2);
+        put_le(buf, e.kind, 1);
+        put_le(buf, e.reason, 1);
+        put_le(buf, e.thread, 2);
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    if (!out) {
+        throw std::runtime_error("Помилка запису " + path);
+    }
+}
+
+std::string search_trace::summarize(const std::string &binary_path, int top) {
+    std::ifstream in(binary_path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data.data());
+    if (data.size() < HEADER_SIZE || std::memcmp(p, MAGIC, sizeof(MAGIC)) != 0 || get_le(p + 8, 4) != VERSION ||
+        get_le(p + 12, 4) != EVENT_SIZE || get_le(p + 16, 8) > (data.size() - HEADER_SIZE) / EVENT_SIZE) {
+        throw std::runtime_error("Файл " + binary_path + " не є журналом пошуку");
+    }
+    std::size_t count = static_cast<std::size_t>(get_le(p + 16, 8));
+
+    // Вузол дерева: рішення, відкрите на своїй глибині, доки його не закриє відкат
+    struct node {
+        int pair, candidate, depth;
+        std::size_t start;
+        long long undos_before;
+    };
+    struct subtree {
+        int pair, candidate, depth;
+        std::size_t events;
+        long long undos;
+    };
+    std::unordered_map<int, std::vector<node>> open;    // відкриті вузли кожного потоку
+    std::unordered_map<int, long long> undos_of_pair;
+    long long kinds[4] = {0}, reasons[6] = {0}, undos = 0;
+    std::vector<subtree> hottest;
+    auto keep = [&](const subtree &s) {
+        // Тримаємо top найбільших піддерев, найменше - на початку купи
+        auto smaller = [](const subtree &a, const subtree &b) { return a.events > b.events; };
+        if (static_cast<int>(hottest.size()) < top) {
+            hottest.push_back(s);
+            std::push_heap(hottest.begin(), hottest.end(), smaller);
+        } else if (top > 0 && s.events > hottest.front().events) {
+            std::pop_heap(hottest.begin(), hottest.end(), smaller);
+            hottest.back() = s;
+            std::push_heap(hottest.begin(), hottest.end(), smaller);
+        }
+    };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned char *q = p + HEADER_SIZE + i * EVENT_SIZE;
+        int pair = static_cast<std::int32_t>(get_le(q + 8, 4));
+        int candidate = static_cast<std::int32_t>(get_le(q + 12, 4));
+        int depth = static_cast<int>(get_le(q + 16, 2));
+        int k = q[20], r = q[21];
+        int thread = static_cast<int>(get_le(q + 22, 2));
+        if (k > solution || r > leaf_2x2) {
+            throw std::runtime_error("Пошкоджена подія " + std::to_string(i) + " у " + binary_path);
+        }
+        kinds[k]++;
+        reasons[r]++;
+        std::vector<node> &stack = open[thread];
+        if (k == decision) {
+            stack.push_back({pair, candidate, depth, i, undos});
+        } else if (k == undo) {
+            undos++;
+            undos_of_pair[pair]++;
+            // Вузли, початок яких загубився при перезаписі кільця, просто не потрапляють у звіт
+            while (!stack.empty() && stack.back().depth > depth) stack.pop_back();
+            if (!stack.empty() && stack.back().depth == depth) {
+                const node &n = stack.back();
+                keep({n.pair, n.candidate, n.depth, i - n.start, undos - n.undos_before});
+                stack.pop_back();
+            }
+        }
+    }
+
+    std::ostringstream out;
+    out << "Подій: " << count << "\n";
+    for (int k = 0; k <= solution; ++k) out << "  " << KIND_NAMES[k] << ": " << kinds[k] << "\n";
+    out << "Причини відкатів і відсікань:\n";
+    for (int r = black_2x2; r <= leaf_2x2; ++r) out << "  " << REASON_NAMES[r] << ": " << reasons[r] << "\n";
+
+    std::sort_heap(hottest.begin(), hottest.end(), [](const subtree &a, const subtree &b) { return a.events > b.events; });
+    out << "Найбільші піддерева:\n";
+    for (const subtree &s : hottest) {
+        out << "  глибина " << s.depth << ", пара " << s.pair << ", кандидат " << s.candidate
+            << ": подій " << s.events << ", відкатів " << s.undos << "\n";
+    }
+
+    std::vector<std::pair<long long, int>> pairs;
+    for (const auto &kv : undos_of_pair) pairs.emplace_back(kv.second, kv.first);
+    std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    out << "Пари з найбільшою кількістю відкатів:\n";
+    for (int i = 0; i < top && i < static_cast<int>(pairs.size()); ++i) {
+        out << "  пара " << pairs[i].second << ": " << pairs[i].first << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Запис дерева пошуку для профілювання: кожне рішення (пара, номер кандидата, розмір острова),
+    кожне відсікання з причиною і кожен відкат з часом від створення запису.
+
+    Кожен потік пише у власне кільце фіксованого розміру без блокувань (найстаріші події перезаписуються);
+    м'ютекс береться лише один раз, коли потік уперше отримує своє кільце. Записи скидаються у JSON
+    формату Chrome trace events (chrome://tracing, Perfetto) і в компактний двійковий журнал,
+    який розбирає summarize.
+
+    Двійковий журнал (little-endian): "NKTRACE1", u32 версія, u32 розмір події, u64 кількість подій,
+    далі події: u64 час (нс), i32 пара, i32 кандидат, u16 глибина, u16 розмір, u8 вид, u8 причина, u16 потік
+*/
+class search_trace {
+public:
+    enum kind : std::uint8_t {
+        decision,   // острів пари розміщено, пошук іде глибше
+        undo,       // острів прибрано: одразу відсічений (reason) або піддерево не дало рішення
+        prune,      // вузол відсічено без розміщення острова або острів відкинуто ще при переборі кандидатів
+        solution    // знайдено рішення
+    };
+
+    enum reason : std::uint8_t {
+        none,
+        black_2x2,      // острів утворив чорний блок 2x2
+        black_split,    // острів розірвав чорну область
+        isolated_clue,  // для якоїсь підказки не залишилося пари
+        pair_exhausted, // усі пари підказки вузла перебрано
+        leaf_2x2        // після заповнення порожніх клітинок з'явився блок 2x2
+    };
+
+    struct event {
+        std::uint64_t ns;
+        std::int32_t pair;
+        std::int32_t candidate;
+        std::uint16_t depth;
+        std::uint16_t size;
+        std::uint8_t kind;
+        std::uint8_t reason;
+        std::uint16_t thread;
+    };
+
+    // Кільце подій одного потоку: push викликає лише потік-власник, snapshot - коли він закінчив запис
+    class ring {
+    public:
+        ring(std::size_t capacity, std::uint16_t thread, std::chrono::steady_clock::time_point origin);
+
+        void push(kind k, reason r, int depth, int pair, int candidate, int size) {
+            std::uint64_t h = head_.load(std::memory_order_relaxed);
+            event &e = events_[h & mask_];
+            e.ns = static_cast<std::uint64_t>((std::chrono::steady_clock::now() - origin_).count());
+            e.pair = pair;
+            e.candidate = candidate;
+            e.depth = static_cast<std::uint16_t>(depth);
+            e.size = static_cast<std::uint16_t>(size);
+            e.kind = k;
+            e.reason = r;
+            e.thread = thread_;
+            head_.store(h + 1, std::memory_order_release);
+        }
+
+        // Події, що залишилися в кільці, від найстарішої
+        std::vector<event> snapshot() const;
+
+    private:
+        std::vector<event> events_;
+        std::size_t mask_;
+        std::atomic<std::uint64_t> head_{0};
+        std::uint16_t thread_;
+        std::chrono::steady_clock::time_point origin_;
+    };
+
+    // ring_capacity округлюється вгору до степеня двійки
+    explicit search_trace(std::size_t ring_capacity = 1 << 16);
+
+    search_trace(const search_trace &) = delete;
+    search_trace &operator=(const search_trace &) = delete;
+
+    // Кільце поточного потоку, створюється при першому зверненні
+    ring &local();
+
+    // Усі події всіх потоків, упорядковані за часом
+    std::vector<event> events() const;
+
+    // Запис у форматі Chrome trace events і в двійковий журнал; у разі помилки кидають std::runtime_error
+    void write_chrome(const std::string &path) const;
+    void write_binary(const std::string &path) const;
+
+    /*
+        Звіт за двійковим журналом: кількість подій за видами і причинами відсікань,
+        top найбільших піддерев (за кількістю подій усередині) і top пар з найбільшою кількістю відкатів
+    */
+    static std::string summarize(const std::string &binary_path, int top = 10);
+
+private:
+    std::size_t capacity_;
+    std::chrono::steady_clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ring>> rings_;
+    std::vector<std::thread::id> owners_;
+};
@@ -0,0 +1,238 @@
+#include "solution_cache.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+static constexpr char MAGIC[8] = {'N', 'K', 'C', 'A', 'C', 'H', 'E', '1'};
+static constexpr std::uint32_t VERSION = 1;
+
+struct solution_cache::header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t slot_size;
+    std::uint64_t slot_count;
+    std::uint64_t clock;        // лічильник звернень, з нього беруться позначки часу записів
+};
+
+struct solution_cache::slot {
+    std::uint64_t hash;         // 0 - порожній запис
+    std::uint64_t stamp;        // позначка останнього звернення для витіснення
+    std::uint16_t rows, cols;
+    std::uint32_t reserved;
+    std::uint16_t clue[MAX_CELLS];      // канонічна задача
+    std::uint16_t order[MAX_CELLS];     // номер острова кожної клітинки в канонічній формі
+};
+
+// Блокування файлу на час одного звернення (flock знімається в деструкторі)
+namespace {
+struct file_lock {
+    int fd;
+    file_lock(int fd, int mode) : fd(fd) {
+        while (::flock(fd, mode) < 0 && errno == EINTR) {}
+    }
+    ~file_lock() { ::flock(fd, LOCK_UN); }
+};
+}
+
+solution_cache::solution_cache(const std::string &path, std::size_t capacity_bytes) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Не вдалося відкрити файл кешу " + path + ": " + std::strerror(errno));
+    }
+    file_lock lock(fd_, LOCK_EX);
+
+    // Якщо файл уже має коректний заголовок, приймаємо його геометрію
+    header existing{};
+    struct stat st{};
+    ::fstat(fd_, &st);
+    bool valid = static_cast<std::size_t>(st.st_size) >= sizeof(header) &&
+                 ::pread(fd_, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+                 std::memcmp(existing.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 existing.version == VERSION && existing.slot_size == sizeof(slot) && existing.slot_count >= WAYS_ &&
+                 static_cast<std::size_t>(st.st_size) == sizeof(header) + existing.slot_count * sizeof(slot);
+
+    if (valid) {
+        slot_count_ = existing.slot_count;
+    } else {
+        slot_count_ = std::max<std::size_t>(WAYS_, capacity_bytes / sizeof(slot)) / WAYS_ * WAYS_;
+    }
+    map_size_ = sizeof(header) + slot_count_ * sizeof(slot);
+
+    if (!valid) {
+        // Обрізання до нуля і розширення заповнюють файл нулями, тобто порожніми записами
+        if (::ftruncate(fd_, 0) < 0 || ::ftruncate(fd_, static_cast<off_t>(map_size_)) < 0) {
+            ::close(fd_);
+            throw std::runtime_error("Не вдалося змінити розмір файлу кешу " + path);
+        }
+    }
+    map_ = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error("Не вдалося відобразити файл кешу " + path + ": " + std::strerror(errno));
+    }
+    if (!valid) {
+        header *h = head();
+        std::memcpy(h->magic, MAGIC, sizeof(MAGIC));
+        h->version = VERSION;
+        h->slot_size = sizeof(slot);
+        h->slot_count = slot_count_;
+        h->clock = 0;
+    }
+}
+
+solution_cache::~solution_cache() {
+    if (map_) ::munmap(map_, map_size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+solution_cache::header *solution_cache::head() const {
+    return static_cast<header *>(map_);
+}
+
+solution_cache::slot *solution_cache::slot_at(std::size_t i) const {
+    return reinterpret_cast<slot *>(static_cast<char *>(map_) + sizeof(header)) + i;
+}
+
+int solution_cache::transform(int t, int r, int c, int rows, int cols) {
+    // Біт 2 - транспонування, біт 0 - віддзеркалення рядків, біт 1 - віддзеркалення стовпців
+    if (t & 4) {
+        std::swap(r, c);
+        std::swap(rows, cols);
+    }
+    if (t & 1) r = rows - 1 - r;
+    if (t & 2) c = cols - 1 - c;
+    return r * cols + c;
+}
+
+int solution_cache::canonical(const grid &puzzle, std::vector<std::uint16_t> &key) {
+    int rows = static_cast<int>(puzzle.size());
+    int cols = rows ? static_cast<int>(puzzle[0].size()) : 0;
+    std::vector<std::uint16_t> candidate(2 + rows * cols);
+    int best = -1;
+    for (int t = 0; t < 8; ++t) {
+        candidate[0] = static_cast<std::uint16_t>(t & 4 ? cols : rows);
+        candidate[1] = static_cast<std::uint16_t>(t & 4 ? rows : cols);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                candidate[2 + transform(t, r, c, rows, cols)] = static_cast<std::uint16_t>(puzzle[r][c]);
+        if (best < 0 || candidate < key) {
+            key = candidate;
+            best = t;
+        }
+    }
+    return best;
+}
+
+std::uint64_t solution_cache::hash(const std::vector<std::uint16_t> &key) {
+    // FNV-1a; нуль зарезервовано для порожнього запису
+    std::uint64_t h = 1469598103934665603ull;
+    for (std::uint16_t v : key) {
+        h = (h ^ v) * 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+void solution_cache::enter_reader() {
+    std::lock_guard<std::mutex> guard(readers_mutex_);
+    if (readers_++ == 0) {
+        while (::flock(fd_, LOCK_SH) < 0 && errno == EINTR) {}
+    }
+}
+
+void solution_cache::leave_reader() {
+    std::lock_guard<std::mutex> guard(readers_mutex_);
+    if (--readers_ == 0) ::flock(fd_, LOCK_UN);
+}
+
+bool solution_cache::lookup(const grid &puzzle, std::vector<int> &order) {
+    int rows = static_cast<int>(puzzle.size());
+    int cols = rows ? static_cast<int>(puzzle[0].size()) : 0;
+    int n = rows * cols;
+    if (n == 0 || n > MAX_CELLS) return false;
+
+    std::vector<std::uint16_t> key;
+    int t = canonical(puzzle, key);
+    std::uint64_t h = hash(key);
+    std::size_t first = h % (slot_count_ / WAYS_) * WAYS_;
+
+    std::shared_lock<std::shared_mutex> guard(mutex_);
+    struct reader {
+        solution_cache &cache;
+        explicit reader(solution_cache &c) : cache(c) { cache.enter_reader(); }
+        ~reader() { cache.leave_reader(); }
+    } lock(*this);
+    for (int w = 0; w < WAYS_; ++w) {
+        slot *s = slot_at(first + w);
+        if (s->hash != h || s->rows != key[0] || s->cols != key[1] ||
+            std::memcmp(s->clue, key.data() + 2, n * sizeof(std::uint16_t)) != 0) continue;
+
+        // Переносимо номери островів з канонічної форми назад у систему координат задачі
+        order.assign(n, 0);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                order[r * cols + c] = s->order[transform(t, r, c, rows, cols)];
+
+        // Під спільним блокуванням позначку можуть оновлювати читачі з інших процесів, тому лише атомарно
+        std::uint64_t now = __atomic_add_fetch(&head()->clock, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->stamp, now, __ATOMIC_RELAXED);
+        hits_++;
+        return true;
+    }
+    misses_++;
+    return false;
+}
+
+void solution_cache::store(const grid &puzzle, const std::vector<int> &order) {
+    int rows = static_cast<int>(puzzle.size());
+    int cols = rows ? static_cast<int>(puzzle[0].size()) : 0;
+    int n = rows * cols;
+    if (n == 0 || n > MAX_CELLS || static_cast<int>(order.size()) != n) return;
+
+    std::vector<std::uint16_t> key;
+    int t = canonical(puzzle, key);
+    std::uint64_t h = hash(key);
+    std::size_t first = h % (slot_count_ / WAYS_) * WAYS_;
+
+    std::unique_lock<std::shared_mutex> guard(mutex_);
+    file_lock lock(fd_, LOCK_EX);
+    std::uint64_t now = __atomic_add_fetch(&head()->clock, 1, __ATOMIC_RELAXED);
+
+    // Порожній запис або той, до якого найдовше не зверталися; той самий ключ лише оновлюємо
+    slot *victim = nullptr;
+    for (int w = 0; w < WAYS_; ++w) {
+        slot *s = slot_at(first + w);
+        if (s->hash == h && s->rows == key[0] && s->cols == key[1] &&
+            std::memcmp(s->clue, key.data() + 2, n * sizeof(std::uint16_t)) == 0) {
+            s->stamp = now;
+            return;
+        }
+        if (!victim || (victim->hash != 0 && (s->hash == 0 || s->stamp < victim->stamp))) victim = s;
+    }
+    if (victim->hash != 0) evictions_++;
+
+    victim->hash = 0;
+    victim->rows = key[0];
+    victim->cols = key[1];
+    std::memcpy(victim->clue, key.data() + 2, n * sizeof(std::uint16_t));
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c)
+            victim->order[transform(t, r, c, rows, cols)] = static_cast<std::uint16_t>(order[r * cols + c]);
+    victim->stamp = now;
+    victim->hash = h;
+    stores_++;
+}
+
+solution_cache::statistics solution_cache::stats() const {
+    statistics s;
+    s.hits = hits_;
+    s.misses = misses_;
+    s.stores = stores_;
+    s.evictions = evictions_;
+    return s;
+}
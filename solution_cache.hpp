@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+/*
+    Кеш розв'язків у файлі, відображеному в пам'ять (mmap), який можуть одночасно використовувати
+    кілька потоків і процесів (пакетні обробники, сервіси).
+
+    Ключ - канонічна форма задачі: найменша з 8 симетрій квадрата (повороти і віддзеркалення),
+    тому повернута або віддзеркалена задача влучає в той самий запис, а розв'язок перетворюється назад.
+    Для кожної клітинки зберігається номер острова в порядку кроків (0 - чорна клітинка),
+    з якого відновлюються і розв'язок, і покроковий журнал.
+
+    Файл має фіксовану кількість записів, згрупованих у набори по WAYS_; при заповненні набору
+    витісняється запис, до якого найдовше не зверталися. Читання бере спільне блокування файлу (flock),
+    запис - виключне
+*/
+class solution_cache {
+public:
+    using grid = std::vector<std::vector<int>>;
+
+    // Найбільша кількість клітинок задачі, яку можна закешувати
+    static constexpr int MAX_CELLS = 1024;
+
+    struct statistics {
+        long long hits = 0;
+        long long misses = 0;
+        long long stores = 0;
+        long long evictions = 0;
+    };
+
+    /*
+        Відкриває або створює файл кешу розміром не більше capacity_bytes.
+        Існуючий коректний файл використовується з його власною кількістю записів (його вже можуть
+        відображати інші процеси), файл з пошкодженим заголовком створюється заново.
+        У разі помилки кидає std::runtime_error
+    */
+    explicit solution_cache(const std::string &path, std::size_t capacity_bytes = 64u << 20);
+    ~solution_cache();
+
+    solution_cache(const solution_cache &) = delete;
+    solution_cache &operator=(const solution_cache &) = delete;
+
+    /*
+        Шукає задачу в кеші. При влучанні записує в order номер острова для кожної клітинки
+        (порядок рядків, 0 - чорна) у системі координат puzzle і повертає true
+    */
+    bool lookup(const grid &puzzle, std::vector<int> &order);
+
+    // Зберігає розв'язок у форматі lookup; задачі понад MAX_CELLS клітинок ігноруються
+    void store(const grid &puzzle, const std::vector<int> &order);
+
+    statistics stats() const;
+
+    std::size_t slot_count() const { return slot_count_; }
+
+private:
+    static constexpr int WAYS_ = 4;
+
+    struct header;
+    struct slot;
+
+    int fd_ = -1;
+    void *map_ = nullptr;
+    std::size_t map_size_ = 0;
+    std::size_t slot_count_ = 0;
+
+    /*
+        flock діє на відкритий файл, а не на потік: перший потік, що зніме спільне блокування, зняв би його
+        і для інших. Тому всередині процесу читачі (lookup) ділять mutex_ спільно, а спільне блокування файлу
+        бере перший з них і знімає останній (лічильник readers_); store тримає mutex_ виключно і бере LOCK_EX
+    */
+    std::shared_mutex mutex_;
+    std::mutex readers_mutex_;
+    int readers_ = 0;
+    std::atomic<long long> hits_{0}, misses_{0}, stores_{0}, evictions_{0};
+
+    header *head() const;
+
+    // Вхід і вихід читача: спільне блокування файлу для всіх читачів процесу
+    void enter_reader();
+    void leave_reader();
+    slot *slot_at(std::size_t i) const;
+
+    /*
+        Будує канонічний ключ (rows, cols, клітинки) і повертає номер симетрії t,
+        яка переводить задачу в канонічну форму
+    */
+    static int canonical(const grid &puzzle, std::vector<std::uint16_t> &key);
+
+    // Індекс клітинки (r, c) задачі rows x cols після симетрії t
+    static int transform(int t, int r, int c, int rows, int cols);
+
+    static std::uint64_t hash(const std::vector<std::uint16_t> &key);
+};
@@ -0,0 +1,511 @@
+#include "solver_service.hpp"
+#include "grid_reader.hpp"
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Найбільший допустимий кадр - захист від зіпсованого заголовка довжини
+static constexpr std::uint32_t MAX_FRAME = 16u << 20;
+
+// Скільки сервіс чекає, поки клієнт надішле весь запит (від прийому з'єднання)
+static constexpr int READ_TIMEOUT_SEC = 5;
+
+// Скільки сервіс чекає, поки клієнт прочитає всю відповідь: клієнт, що не читає, не повинен займати потік
+static constexpr int WRITE_TIMEOUT_SEC = 10;
+
+// Найбільша кількість з'єднань, запит яких ще читається; понад неї нові з'єднання чекають у черзі listen
+static constexpr std::size_t MAX_PENDING = 1024;
+
+// Найбільша кількість клітинок сітки в запиті: розміри перевіряються до виділення пам'яті під сітку
+static constexpr long long MAX_REQUEST_CELLS = 1 << 20;
+
+static bool is_port(const std::string &address) {
+    return !address.empty() && std::all_of(address.begin(), address.end(), [](char ch) { return ch >= '0' && ch <= '9'; });
+}
+
+static std::runtime_error socket_error(const std::string &what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+/*
+    Створює сокет для адреси: рядок з цифр - TCP-порт на 127.0.0.1, інакше - шлях до Unix-сокета.
+    listen = true - сокет прив'язується і слухає, інакше - з'єднується з сервісом
+*/
+static int open_socket(const std::string &address, bool listen) {
+    int fd;
+    if (is_port(address)) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(std::stoi(address)));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) throw socket_error("Не вдалося створити сокет");
+        int rc;
+        if (listen) {
+            int yes = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            rc = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        } else {
+            rc = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        }
+        if (rc < 0) {
+            auto err = socket_error("Не вдалося відкрити адресу " + address);
+            ::close(fd);
+            throw err;
+        }
+    } else {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Занадто довгий шлях до сокета: " + address);
+        }
+        std::strcpy(addr.sun_path, address.c_str());
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) throw socket_error("Не вдалося створити сокет");
+        int rc;
+        if (listen) {
+            // Файл сокета від попереднього запуску заважає bind
+            ::unlink(address.c_str());
+            rc = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        } else {
+            rc = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        }
+        if (rc < 0) {
+            auto err = socket_error("Не вдалося відкрити адресу " + address);
+            ::close(fd);
+            throw err;
+        }
+    }
+    if (listen && ::listen(fd, 128) < 0) {
+        auto err = socket_error("Не вдалося слухати адресу " + address);
+        ::close(fd);
+        throw err;
+    }
+    return fd;
+}
+
+using steady_time = std::chrono::steady_clock::time_point;
+
+// Без обмеження часу (клієнт) - блокуючий запис
+static constexpr steady_time NO_DEADLINE = steady_time::max();
+
+static steady_time write_deadline() {
+    return std::chrono::steady_clock::now() + std::chrono::seconds(WRITE_TIMEOUT_SEC);
+}
+
+static bool write_all(int fd, const char *data, std::size_t size, steady_time deadline) {
+    const bool limited = deadline != NO_DEADLINE;
+    while (size > 0) {
+        // MSG_NOSIGNAL: клієнт, що відключився, не повинен вбивати сервіс сигналом SIGPIPE
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL | (limited ? MSG_DONTWAIT : 0));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && limited && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Буфер сокета заповнений - чекаємо, доки клієнт читає, але не довше за крайній термін
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) return false;
+            pollfd p{fd, POLLOUT, 0};
+            if (::poll(&p, 1, static_cast<int>(left.count())) < 0 && errno != EINTR) return false;
+            continue;
+        }
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static bool read_all(int fd, char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static bool send_frame(int fd, const std::string &payload, steady_time deadline = NO_DEADLINE) {
+    std::uint32_t len = static_cast<std::uint32_t>(payload.size());
+    unsigned char header[4] = {
+        static_cast<unsigned char>(len >> 24), static_cast<unsigned char>(len >> 16),
+        static_cast<unsigned char>(len >> 8), static_cast<unsigned char>(len)
+    };
+    return write_all(fd, reinterpret_cast<const char *>(header), 4, deadline) &&
+           write_all(fd, payload.data(), payload.size(), deadline);
+}
+
+static bool recv_frame(int fd, std::string &payload) {
+    unsigned char header[4];
+    if (!read_all(fd, reinterpret_cast<char *>(header), 4)) return false;
+    std::uint32_t len = (std::uint32_t(header[0]) << 24) | (std::uint32_t(header[1]) << 16) |
+                        (std::uint32_t(header[2]) << 8) | std::uint32_t(header[3]);
+    if (len > MAX_FRAME) return false;
+    payload.resize(len);
+    return read_all(fd, payload.data(), len);
+}
+
+solver_service::solver_service(options opt) : opt_(std::move(opt)) {
+    if (opt_.workers < 1 || opt_.queue_capacity < 1) {
+        throw std::runtime_error("Кількість потоків і місткість черги мають бути додатними");
+    }
+    if (!opt_.cache_path.empty()) cache_ = std::make_unique<solution_cache>(opt_.cache_path);
+    listen_fd_ = open_socket(opt_.address, true);
+    latencies_.reserve(LATENCY_RING_);
+    for (int i = 0; i < opt_.workers; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+solver_service::~solver_service() {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &t : workers_) t.join();
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    if (!is_port(opt_.address)) ::unlink(opt_.address.c_str());
+}
+
+void solver_service::stop() {
+    stopping_ = true;
+    // shutdown перериває accept, заблокований в іншому потоці
+    if (listen_fd_ >= 0) ::shutdown(listen_fd_, SHUT_RDWR);
+}
+
+static void set_nonblocking(int fd, bool on) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, on ? flags | O_NONBLOCK : flags & ~O_NONBLOCK);
+}
+
+/*
+    Потік прийому не блокується на жодному клієнті: усі з'єднання, запит яких ще не дочитано, опитуються через poll,
+    і кожне має крайній термін на весь запит. Повільний чи мовчазний клієнт займає лише свій слот
+*/
+void solver_service::run() {
+    struct pending {
+        int fd;
+        std::string buf;
+        clock::time_point deadline;
+    };
+    std::vector<pending> conns;
+    std::vector<pollfd> fds;
+    char chunk[1 << 16];
+
+    while (!stopping_) {
+        fds.clear();
+        // Коли слотів немає, слухаючий сокет не опитується - з'єднання чекають у черзі listen
+        fds.push_back({listen_fd_, static_cast<short>(conns.size() < MAX_PENDING ? POLLIN : 0), 0});
+        clock::time_point now = clock::now();
+        int timeout = -1;
+        for (const pending &p : conns) {
+            fds.push_back({p.fd, POLLIN, 0});
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(p.deadline - now).count() + 1;
+            if (timeout < 0 || left < timeout) timeout = static_cast<int>(std::max<long long>(left, 0));
+        }
+        if (::poll(fds.data(), fds.size(), timeout) < 0) {
+            if (errno == EINTR) continue;
+            throw socket_error("Помилка очікування з'єднань");
+        }
+        if (stopping_) break;
+
+        // Дочитуємо запити; завершене, закрите чи прострочене з'єднання виходить зі списку
+        now = clock::now();
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < conns.size(); ++i) {
+            pending &p = conns[i];
+            bool done = false, drop = now >= p.deadline;
+            if (!drop && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+                ssize_t n = ::recv(p.fd, chunk, sizeof(chunk), 0);
+                if (n > 0) {
+                    p.buf.append(chunk, static_cast<std::size_t>(n));
+                } else if (n == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    drop = true;
+                }
+                if (!drop && p.buf.size() >= 4) {
+                    const unsigned char *h = reinterpret_cast<const unsigned char *>(p.buf.data());
+                    std::uint32_t len = (std::uint32_t(h[0]) << 24) | (std::uint32_t(h[1]) << 16) |
+                                        (std::uint32_t(h[2]) << 8) | std::uint32_t(h[3]);
+                    if (len > MAX_FRAME) drop = true;
+                    else done = p.buf.size() >= 4 + static_cast<std::size_t>(len);
+                    if (done) {
+                        set_nonblocking(p.fd, false);
+                        handle_request(p.fd, p.buf.substr(4, len));
+                    }
+                }
+            }
+            if (drop) ::close(p.fd);
+            if (!drop && !done) {
+                if (kept != i) conns[kept] = std::move(p);
+                kept++;
+            }
+        }
+        conns.resize(kept);
+
+        if (fds[0].revents & POLLIN) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED && !stopping_) {
+                    throw socket_error("Помилка прийому з'єднання");
+                }
+            } else {
+                set_nonblocking(fd, true);
+                conns.push_back({fd, std::string(), clock::now() + std::chrono::seconds(READ_TIMEOUT_SEC)});
+            }
+        } else if (fds[0].revents & (POLLHUP | POLLERR)) {
+            // Слухаючий сокет закрито через stop()
+            break;
+        }
+    }
+    for (const pending &p : conns) ::close(p.fd);
+    ready_.notify_all();
+}
+
+// Обробляє прочитаний запит у потоці прийому: STATS і STOP виконуються одразу, SOLVE стає в чергу
+void solver_service::handle_request(int fd, const std::string &payload) {
+    std::istringstream in(payload);
+    std::string command;
+    in >> command;
+
+    if (command == "STATS") {
+        send_frame(fd, stats_report(), write_deadline());
+        ::close(fd);
+        return;
+    }
+    if (command == "STOP") {
+        send_frame(fd, "OK", write_deadline());
+        ::close(fd);
+        stop();
+        return;
+    }
+    if (command != "SOLVE") {
+        send_frame(fd, "ERROR Невідома команда: " + command, write_deadline());
+        ::close(fd);
+        return;
+    }
+
+    job j;
+    j.fd = fd;
+    try {
+        std::string engine;
+        if (!(in >> engine >> j.deadline_ms) || j.deadline_ms < 0) {
+            throw std::runtime_error("Невірний заголовок запиту");
+        }
+        j.mode = nurikabe_solver::parse_engine(engine);
+        std::streampos grid_start = in.tellg();
+        long long rows = 0, cols = 0;
+        if (!(in >> rows >> cols) || rows <= 0 || cols <= 0 || rows > MAX_REQUEST_CELLS / cols) {
+            throw std::runtime_error("Невірні розміри сітки");
+        }
+        in.seekg(grid_start);
+        grid_data data = grid_reader::from_stream(in);
+        std::string problem = grid_reader::validate(data);
+        if (!problem.empty()) throw std::runtime_error("Невірна задача: " + problem);
+        j.initial = std::move(data.grid);
+    } catch (const std::exception &e) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requested_++;
+            failed_++;
+        }
+        send_frame(fd, std::string("ERROR ") + e.what(), write_deadline());
+        ::close(fd);
+        return;
+    }
+    j.enqueued = clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requested_++;
+        if (static_cast<int>(queue_.size()) >= opt_.queue_capacity) {
+            rejected_++;
+        } else {
+            queue_.push_back(std::move(j));
+            max_depth_ = std::max(max_depth_, queue_.size());
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        // Черга переповнена - відмовляємо одразу, щоб клієнт міг повторити запит пізніше
+        send_frame(fd, "ERROR Черга переповнена", write_deadline());
+        ::close(fd);
+        return;
+    }
+    ready_.notify_one();
+}
+
+void solver_service::worker_loop() {
+    nurikabe_solver solver;
+    solver.attach_cache(cache_.get());
+    // Кадри кроків збираються в буфер рендерера, який живе разом з потоком
+    step_renderer renderer({step_renderer::format::plain, step_renderer::verbosity::all});
+    for (;;) {
+        job j;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            // Після зупинки потоки дорозв'язують уже прийняті запити
+            if (queue_.empty()) return;
+            j = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        serve(j, solver, renderer);
+        ::close(j.fd);
+    }
+}
+
+void solver_service::serve(job &j, nurikabe_solver &solver, step_renderer &renderer) {
+    // Крайній термін рахується від моменту прийому, тож час очікування в черзі теж враховано
+    std::optional<clock::time_point> deadline;
+    if (j.deadline_ms > 0) deadline = j.enqueued + std::chrono::milliseconds(j.deadline_ms);
+    solver.set_deadline(deadline);
+
+    std::vector<grid> steps;
+    std::string error;
+    try {
+        steps = solver.solve(j.initial, j.mode);
+    } catch (const std::exception &e) {
+        // Окрім помилок розв'язання, тут і нестача пам'яті: один запит не повинен зупиняти сервіс
+        error = e.what();
+    }
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - j.enqueued).count();
+
+    // Уся відповідь має бути прочитана до крайнього терміну, інакше з'єднання кидається, а запит вважається невдалим
+    steady_time deadline_out = write_deadline();
+    bool sent;
+    if (!error.empty()) {
+        sent = send_frame(j.fd, "ERROR " + error, deadline_out);
+    } else {
+        sent = true;
+        std::string frame;
+        for (std::size_t i = 0; i < steps.size() && sent; ++i) {
+            frame = "STEP " + std::to_string(i + 1) + ' ' + std::to_string(steps.size()) + '\n';
+            frame += renderer.render(steps[i]);
+            sent = send_frame(j.fd, frame, deadline_out);
+        }
+        if (sent) {
+            std::ostringstream done;
+            done << "OK " << ms;
+            sent = send_frame(j.fd, done.str(), deadline_out);
+        }
+    }
+    record(ms, error.empty() && sent);
+}
+
+void solver_service::record(double latency_ms, bool ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ok) completed_++;
+    else failed_++;
+    if (latencies_.size() < LATENCY_RING_) {
+        latencies_.push_back(latency_ms);
+    } else {
+        latencies_[latency_next_] = latency_ms;
+    }
+    latency_next_ = (latency_next_ + 1) % LATENCY_RING_;
+}
+
+std::string solver_service::stats_report() {
+    std::vector<double> sample;
+    std::ostringstream out;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sample = latencies_;
+        out << "workers " << opt_.workers << '\n'
+            << "queue_depth " << queue_.size() << '\n'
+            << "queue_max " << max_depth_ << '\n'
+            << "queue_capacity " << opt_.queue_capacity << '\n'
+            << "requested " << requested_ << '\n'
+            << "completed " << completed_ << '\n'
+            << "failed " << failed_ << '\n'
+            << "rejected " << rejected_ << '\n';
+    }
+    // Перцентилі рахуються за останніми LATENCY_RING_ запитами
+    auto percentile = [&](double q) {
+        if (sample.empty()) return 0.0;
+        // Найближчий ранг: p99 з кількох вибірок - найповільніший запит, а не найшвидший
+        std::size_t n = sample.size();
+        std::size_t k = static_cast<std::size_t>(std::ceil(q * n));
+        k = std::min(std::max<std::size_t>(k, 1), n) - 1;
+        std::nth_element(sample.begin(), sample.begin() + k, sample.end());
+        return sample[k];
+    };
+    out << "p50_ms " << percentile(0.50) << '\n'
+        << "p99_ms " << percentile(0.99) << '\n';
+    if (cache_) {
+        solution_cache::statistics cs = cache_->stats();
+        out << "cache_hits " << cs.hits << '\n'
+            << "cache_misses " << cs.misses << '\n'
+            << "cache_stores " << cs.stores << '\n'
+            << "cache_evictions " << cs.evictions << '\n';
+    }
+    return out.str();
+}
+
+// Надсилає один запит і повертає сокет для читання відповіді
+static int send_request(const std::string &address, const std::string &payload) {
+    int fd = open_socket(address, false);
+    if (!send_frame(fd, payload)) {
+        ::close(fd);
+        throw std::runtime_error("Не вдалося надіслати запит сервісу");
+    }
+    return fd;
+}
+
+std::vector<service_client::grid> service_client::solve(const std::string &address, const grid &initial,
+                                                        const std::string &engine, int deadline_ms) {
+    std::ostringstream req;
+    req << "SOLVE " << engine << ' ' << deadline_ms << '\n';
+    step_renderer renderer({step_renderer::format::plain, step_renderer::verbosity::all});
+    req << renderer.render(initial);
+    int fd = send_request(address, req.str());
+
+    std::vector<grid> steps;
+    std::string payload;
+    while (recv_frame(fd, payload)) {
+        std::istringstream in(payload);
+        std::string kind;
+        in >> kind;
+        if (kind == "STEP") {
+            int index, total;
+            in >> index >> total;
+            steps.push_back(grid_reader::from_stream(in).grid);
+        } else if (kind == "OK") {
+            ::close(fd);
+            return steps;
+        } else {
+            ::close(fd);
+            std::string message = payload.size() > 6 ? payload.substr(6) : payload;
+            throw std::runtime_error(message);
+        }
+    }
+    ::close(fd);
+    throw std::runtime_error("Сервіс закрив з'єднання без відповіді");
+}
+
+std::string service_client::stats(const std::string &address) {
+    int fd = send_request(address, "STATS");
+    std::string payload;
+    bool ok = recv_frame(fd, payload);
+    ::close(fd);
+    if (!ok) throw std::runtime_error("Сервіс закрив з'єднання без відповіді");
+    return payload;
+}
+
+void service_client::stop(const std::string &address) {
+    int fd = send_request(address, "STOP");
+    std::string payload;
+    recv_frame(fd, payload);
+    ::close(fd);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "nurikabe_solver.hpp"
+#include "solution_cache.hpp"
+#include "step_renderer.hpp"
+
+/*
+    Постійний сервіс розв'язання: слухає Unix-сокет або TCP-порт на 127.0.0.1,
+    ставить запити в обмежену чергу і розв'язує їх пулом робочих потоків.
+    Кожен потік має власний nurikabe_solver, тому буфери і арени переживають між запитами.
+
+    Протокол - кадри "4 байти довжини (big-endian) + текст":
+      запит   SOLVE <search|dlx|sat> <deadline_ms>\n<rows> <cols>\n<сітка>   (deadline_ms = 0 - без обмеження)
+              STATS
+              STOP
+      відповідь на SOLVE - кадри "STEP <i> <n>\n<сітка>" для кожного кроку, потім "OK <ms>" або "ERROR <повідомлення>"
+      відповідь на STATS - один кадр з рядками "назва значення"
+*/
+class solver_service {
+public:
+    using grid = nurikabe_solver::grid;
+
+    struct options {
+        std::string address;        // шлях до Unix-сокета або номер TCP-порту
+        int workers = 2;            // кількість робочих потоків
+        int queue_capacity = 64;    // максимальна кількість запитів, що очікують
+        std::string cache_path;     // файл спільного кешу розв'язків (порожній - без кешу)
+    };
+
+    explicit solver_service(options opt);
+    ~solver_service();
+
+    solver_service(const solver_service &) = delete;
+    solver_service &operator=(const solver_service &) = delete;
+
+    // Приймає з'єднання, доки не надійде STOP або не буде викликано stop()
+    void run();
+
+    // Зупиняє прийом з'єднань; запити, що вже в черзі, буде дорозв'язано
+    void stop();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct job {
+        int fd;
+        grid initial;
+        nurikabe_solver::engine mode;
+        int deadline_ms;
+        clock::time_point enqueued;
+    };
+
+    options opt_;
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    std::unique_ptr<solution_cache> cache_;   // спільний для всіх робочих потоків
+
+    std::vector<std::thread> workers_;
+    std::deque<job> queue_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+
+    // Статистика (захищена mutex_)
+    static constexpr int LATENCY_RING_ = 4096;
+    std::vector<double> latencies_;           // кільце останніх затримок, мс
+    std::size_t latency_next_ = 0;
+    std::size_t max_depth_ = 0;
+    long long requested_ = 0, completed_ = 0, failed_ = 0, rejected_ = 0;
+
+    void worker_loop();
+    void handle_request(int fd, const std::string &payload);
+    void serve(job &j, nurikabe_solver &solver, step_renderer &renderer);
+    void record(double latency_ms, bool ok);
+    std::string stats_report();
+};
+
+// Клієнтська частина протоколу solver_service
+class service_client {
+public:
+    using grid = nurikabe_solver::grid;
+
+    /*
+        Надсилає задачу на розв'язання і повертає покрокове рішення.
+        Якщо сервіс відповів ERROR, кидає std::runtime_error з його повідомленням
+    */
+    static std::vector<grid> solve(const std::string &address, const grid &initial,
+                                   const std::string &engine, int deadline_ms = 0);
+
+    // Повертає звіт статистики сервісу
+    static std::string stats(const std::string &address);
+
+    // Просить сервіс завершити роботу
+    static void stop(const std::string &address);
+};
@@ -0,0 +1,174 @@
+#include "step_renderer.hpp"
+#include <stdexcept>
+#include <charconv>
+
+// Значення клітинок такі ж, як у розв'язувачі
+static constexpr int EMPTY = 0, BLACK = -1, FILLED = -2;
+
+step_renderer::format step_renderer::parse_format(const std::string &name) {
+    if (name == "box") return format::box;
+    if (name == "ascii") return format::ascii;
+    if (name == "json") return format::json;
+    if (name == "delta") return format::delta;
+    if (name == "plain") return format::plain;
+    throw std::runtime_error("Невідомий формат виводу: " + name);
+}
+
+step_renderer::verbosity step_renderer::parse_verbosity(const std::string &name) {
+    if (name == "all") return verbosity::all;
+    if (name == "final") return verbosity::final_only;
+    if (name == "quiet") return verbosity::quiet;
+    throw std::runtime_error("Невідомий режим виводу: " + name);
+}
+
+const std::string &step_renderer::render(const grid &g, std::size_t index, std::size_t total) {
+    // clear() зберігає місткість, тож після першого кадру буфер більше не виділяє пам'ять
+    buf_.clear();
+    switch (opt_.fmt) {
+        case format::box:
+            append_header(index, total, ":\n");
+            render_box(g);
+            break;
+        case format::ascii:
+            append_header(index, total, ":\n");
+            render_ascii(g);
+            break;
+        case format::json:  render_json(g, index, total); break;
+        case format::delta:
+            append_header(index, total, ":");
+            render_delta(g);
+            break;
+        case format::plain: render_plain(g); break;
+    }
+    return buf_;
+}
+
+void step_renderer::write_steps(std::ostream &out, const std::vector<grid> &steps) {
+    if (opt_.level == verbosity::quiet || steps.empty()) return;
+    std::size_t first = opt_.level == verbosity::final_only ? steps.size() - 1 : 0;
+    for (std::size_t i = first; i < steps.size(); ++i) {
+        const std::string &frame = render(steps[i], i, steps.size());
+        out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+    }
+    out.flush();
+}
+
+void step_renderer::append_int(int v) {
+    char digits[16];
+    auto res = std::to_chars(digits, digits + sizeof(digits), v);
+    buf_.append(digits, res.ptr);
+}
+
+void step_renderer::append_header(std::size_t index, std::size_t total, const char *tail) {
+    if (total == 0) return;
+    buf_ += "Крок ";
+    append_int(static_cast<int>(index + 1));
+    buf_ += " з ";
+    append_int(static_cast<int>(total));
+    buf_ += tail;
+}
+
+void step_renderer::render_box(const grid &g) {
+    int cols = g.empty() ? 0 : static_cast<int>(g[0].size());
+
+    // Верхня межа
+    buf_ += "┌";
+    for (int c = 0; c < cols; ++c) buf_ += "───";
+    buf_ += "┐\n";
+
+    // Вміст рядків: кожна клітинка займає три символи
+    for (const auto &row : g) {
+        buf_ += "│";
+        for (int v : row) {
+            if (v == FILLED) buf_ += " #";
+            else if (v == BLACK) buf_ += " X";
+            else {
+                if (v >= 0 && v < 10) buf_ += ' ';
+                append_int(v);
+            }
+            buf_ += ' ';
+        }
+        buf_ += "│\n";
+    }
+
+    // Нижня межа
+    buf_ += "└";
+    for (int c = 0; c < cols; ++c) buf_ += "───";
+    buf_ += "┘\n";
+}
+
+// Символ клітинки для ascii і delta
+static char cell_char(int v) {
+    if (v == FILLED) return '#';
+    if (v == BLACK) return 'x';
+    if (v == EMPTY) return '.';
+    if (v >= 1 && v <= 9) return static_cast<char>('0' + v);
+    if (v >= 10 && v <= 35) return static_cast<char>('a' + v - 10);
+    return '?';
+}
+
+void step_renderer::render_ascii(const grid &g) {
+    for (const auto &row : g) {
+        for (int v : row) buf_ += cell_char(v);
+        buf_ += '\n';
+    }
+}
+
+void step_renderer::render_json(const grid &g, std::size_t index, std::size_t total) {
+    buf_ += '{';
+    if (total > 0) {
+        buf_ += "\"step\":";
+        append_int(static_cast<int>(index + 1));
+        buf_ += ",\"total\":";
+        append_int(static_cast<int>(total));
+        buf_ += ',';
+    }
+    buf_ += "\"rows\":";
+    append_int(static_cast<int>(g.size()));
+    buf_ += ",\"cols\":";
+    append_int(g.empty() ? 0 : static_cast<int>(g[0].size()));
+    buf_ += ",\"cells\":[";
+    for (std::size_t r = 0; r < g.size(); ++r) {
+        buf_ += r ? ",[" : "[";
+        for (std::size_t c = 0; c < g[r].size(); ++c) {
+            if (c) buf_ += ',';
+            append_int(g[r][c]);
+        }
+        buf_ += ']';
+    }
+    buf_ += "]}\n";
+}
+
+void step_renderer::render_delta(const grid &g) {
+    // Кадр іншого розміру порівнюється з порожньою сіткою
+    bool comparable = previous_.size() == g.size() && (g.empty() || previous_[0].size() == g[0].size());
+    for (std::size_t r = 0; r < g.size(); ++r) {
+        for (std::size_t c = 0; c < g[r].size(); ++c) {
+            int before = comparable ? previous_[r][c] : EMPTY;
+            if (g[r][c] == before) continue;
+            buf_ += ' ';
+            append_int(static_cast<int>(r + 1));
+            buf_ += ',';
+            append_int(static_cast<int>(c + 1));
+            buf_ += '=';
+            if (g[r][c] > 0) append_int(g[r][c]);
+            else buf_ += cell_char(g[r][c]);
+        }
+    }
+    buf_ += '\n';
+    previous_ = g;
+}
+
+void step_renderer::render_plain(const grid &g) {
+    append_int(static_cast<int>(g.size()));
+    buf_ += ' ';
+    append_int(g.empty() ? 0 : static_cast<int>(g[0].size()));
+    buf_ += '\n';
+    for (const auto &row : g) {
+        for (std::size_t c = 0; c < row.size(); ++c) {
+            if (c) buf_ += ' ';
+            append_int(row[c]);
+        }
+        buf_ += '\n';
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+/*
+    Вивід кроків розв'язання. Кожен кадр збирається в перевикористовуваний буфер
+    і записується в потік одним викликом, без форматування потоку на кожну клітинку.
+
+    Формати:
+      box    - рамка з псевдографіки (як у меню), "#" - клітинка острова, "X" - чорна
+      ascii  - по символу на клітинку: "#", "x", "." і підказки 1-9, a-z (10-35)
+      json   - один об'єкт на рядок: {"step":i,"total":n,"rows":r,"cols":c,"cells":[[...]]}
+      delta  - лише клітинки, що змінилися від попереднього кадру: "Крок i з n: рядок,стовпець=значення ..."
+      plain  - "rows cols" і сітка числами, як у вхідних файлах (формат кадрів сервісу)
+*/
+class step_renderer {
+public:
+    using grid = std::vector<std::vector<int>>;
+
+    enum class format { box, ascii, json, delta, plain };
+
+    // Які кадри виводить write_steps
+    enum class verbosity {
+        all,        // усі кроки
+        final_only, // лише останній крок
+        quiet       // нічого
+    };
+
+    struct options {
+        format fmt = format::box;
+        verbosity level = verbosity::all;
+    };
+
+    step_renderer() = default;
+    explicit step_renderer(options opt) : opt_(opt) {}
+
+    // Перетворює назву формату (box, ascii, json, delta, plain) на format, для невідомої кидає std::runtime_error
+    static format parse_format(const std::string &name);
+    // all, final, quiet
+    static verbosity parse_verbosity(const std::string &name);
+
+    /*
+        Кадр кроку index (з 0) із total; total = 0 - окрема сітка без заголовка кроку.
+        Посилання дійсне до наступного виклику render
+    */
+    const std::string &render(const grid &g, std::size_t index = 0, std::size_t total = 0);
+
+    // Записує кроки в out з урахуванням verbosity, по одному виклику write на кадр
+    void write_steps(std::ostream &out, const std::vector<grid> &steps);
+
+    // Забуває попередній кадр (наступний кадр delta міститиме всі непорожні клітинки)
+    void reset() { previous_.clear(); }
+
+private:
+    options opt_;
+    std::string buf_;
+    grid previous_;     // попередній кадр для формату delta
+
+    void append_int(int v);
+    void append_header(std::size_t index, std::size_t total, const char *tail);
+    void render_box(const grid &g);
+    void render_ascii(const grid &g);
+    void render_json(const grid &g, std::size_t index, std::size_t total);
+    void render_delta(const grid &g);
+    void render_plain(const grid &g);
+};
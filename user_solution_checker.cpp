@@ -1,7 +1,10 @@
 #include "user_solution_checker.hpp"
 #include <limits>
-#include <queue>
 #include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
 
 user_solution_checker::user_solution_checker(const std::vector<std::vector<int>>& initialGrid) : initial_(initialGrid),
     rows_(static_cast<int>(initialGrid.size())),
@@ -82,28 +85,13 @@ bool user_solution_checker::input_phase(std::istream& in, std::ostream& out) {
 }
 
 bool user_solution_checker::validation_phase(std::ostream& out) {
-    // Координати верхнього лівого кута чорного блока 2x2, якщо він буде
-    cell lt;
-    if (check_black_2x2_block(lt)) {
-        // Якщо чорний блок було знайдено, виводим помилку і координати лівого верхнього кута
-        out << "\nПомилка: знайдено 2×2 чорний блок у клітині ("
-            << lt.row+1 << "," << lt.col+1 << ")\n";
-        return false;
-    }
-    // Перевірка чорної області на зв'язність
-    if (!check_black_connectivity()) {
-        out << "\nПомилка: чорна область незв'язна\n";
-        return false;
-    }
-    // Причина помилки
-    std::string reason;
-    // Клітинка де знайдена помилка
-    cell loc;
-    if (!check_islands(reason, loc)) {
-        out << "\nПомилка: " << reason;
-        if (loc.row >= 0)
-            out << " (рядок " << loc.row+1 << ", стовпець " << loc.col+1 << ")";
+    // Виводимо всі знайдені порушення, а не лише перше
+    std::vector<violation> found = validate(initial_, user_grid_);
+    if (!found.empty()) {
         out << "\n";
+        for (const violation &v : found) {
+            out << "Помилка: " << v.reason << "\n";
+        }
         return false;
     }
 
@@ -111,114 +99,155 @@ bool user_solution_checker::validation_phase(std::ostream& out) {
     return true;
 }
 
-// Метод для перевірки наявності чорних блоків 2x2 і повернення лівої верхньої клітинки проблемного блоку
-bool user_solution_checker::check_black_2x2_block(cell &lt) const {
-    for (int r = 0; r+1 < rows_; ++r) {
-        for (int c = 0; c+1 < cols_; ++c) {
-            if (user_grid_[r][c]==-1 &&
-                user_grid_[r+1][c]==-1 &&
-                user_grid_[r][c+1]==-1 &&
-                user_grid_[r+1][c+1]==-1)
-            {
-                lt.row = r; lt.col = c;
-                return true;
-            }
+namespace {
+// Система неперетинних множин над клітинками з підсумками кожної множини в її корені
+struct cell_sets {
+    std::vector<int> parent, size, clues, clue_sum, first_clue;
+
+    explicit cell_sets(int n) : parent(n), size(n, 1), clues(n, 0), clue_sum(n, 0), first_clue(n, -1) {
+        for (int i = 0; i < n; ++i) parent[i] = i;
+    }
+
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
         }
+        return x;
     }
-    return false;
+
+    // Об'єднання за розміром; корінь меншої множини передає свої підсумки більшій
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (size[a] < size[b]) std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+        clues[a] += clues[b];
+        clue_sum[a] += clue_sum[b];
+        if (first_clue[a] < 0 || (first_clue[b] >= 0 && first_clue[b] < first_clue[a])) first_clue[a] = first_clue[b];
+    }
+};
+
+std::string at(int r, int c) {
+    return " (рядок " + std::to_string(r + 1) + ", стовпець " + std::to_string(c + 1) + ")";
+}
 }
 
-// Метод для перевірки зв'язності чорної області
-bool user_solution_checker::check_black_connectivity() const {
-    std::vector<char> vis(rows_ * cols_, 0);
-    cell start(-1, -1);
-    int total_black = 0;
-    for (int r = 0; r < rows_; ++r)
-        for (int c = 0; c < cols_; ++c)
-            if (user_grid_[r][c] == -1) {
-                if (start.row < 0) start = cell(r, c);
-                ++total_black;
-            }
-    if (start.row < 0) return true;
-    std::queue<cell> q;
-    q.push(start);
-    vis[start.row * cols_ + start.col] = 1;
-    int count = 0;
-    while (!q.empty()) {
-        cell u = q.front(); q.pop();
-        ++count;
-        for (int d = 0; d < 4; ++d) {
-            int nr = u.row + DR_[d], nc = u.col + DC_[d];
-            int nid = nr * cols_ + nc;
-            if (out_of_bounds(nr, nc) || vis[nid] || user_grid_[nr][nc] != -1)
-                continue;
-            vis[nid] = 1;
-            q.push(cell(nr, nc));
+std::vector<user_solution_checker::violation> user_solution_checker::validate(const grid &puzzle, const grid &solution) {
+    const int rows = static_cast<int>(puzzle.size());
+    const int cols = rows ? static_cast<int>(puzzle[0].size()) : 0;
+    std::vector<violation> found;
+    // Кожен рядок перевіряється окремо: рядки різної довжини вивели б індекси за межі при об'єднанні клітинок
+    for (const auto &row : puzzle) {
+        if (static_cast<int>(row.size()) != cols) {
+            found.push_back({violation::bad_cell, cell(-1, -1), "рядки задачі мають різну довжину"});
+            return found;
         }
     }
-    return count == total_black;
-}
+    bool same_size = static_cast<int>(solution.size()) == rows;
+    for (int r = 0; same_size && r < rows; ++r) same_size = static_cast<int>(solution[r].size()) == cols;
+    if (!same_size) {
+        found.push_back({violation::bad_cell, cell(-1, -1), "розмір рішення не збігається з розміром задачі"});
+        return found;
+    }
 
-// Метод для перевірки площі островів (повинна мати площу сумі двух клітинок з цифрами)
-bool user_solution_checker::check_islands(std::string &reason, cell &loc) const {
-    // Список для зберігання пройдених клітинок
-    std::vector<char> vis(rows_ * cols_, 0);
+    // Колір клітинки: 1 - біла (підказка або заповнена), 0 - чорна, -1 - некоректна
+    auto colour = [&](int r, int c) {
+        int v = solution[r][c];
+        if (v == -1) return 0;
+        if (v == -2 || v > 0) return 1;
+        return -1;
+    };
 
-    for (int r = 0; r < rows_; ++r) {
-        for (int c = 0; c < cols_; ++c) {
-            // Якщо клітинка не пройдена і належить білій області - перевіряємо її
-            if (!vis[r * cols_ + c] && (user_grid_[r][c] > 0 || user_grid_[r][c] == -2)) {
-                // Черга для проходу в ширину по білій області
-                std::queue<cell> q;
-                cell start(-1, -1), end(-1, -1);
-                // Змінна для підрахунку розміру білої області
-                int size = 0;
-                // Додаємо в чергу стартову клітинку і помічаємо її як пройдену
-                q.push(cell(r, c));
-                vis[r * cols_ + c] = 1;
-
-                // Проходимося по всім клітинкам і рахуємо розмір області, також паралельно записуємо в start і end клітинки з підказками
-                while (!q.empty()) {
-                    cell u = q.front(); q.pop();
-                    size++;
-                    if (user_grid_[u.row][u.col] > 0) {
-                        if (start.row == -1) {
-                            start = u;
-                        } else if (end.row == -1) {
-                            end = u;
-                        } else {
-                            reason = "острів має більше 2 підказки";
-                            loc = u;
-                            return false;
-                        }
-                    }
-                    for (int d = 0; d < 4; ++d) {
-                        int nr = u.row + DR_[d], nc = u.col + DC_[d];
-                        int nid = nr * cols_ + nc;
-                        if (out_of_bounds(nr, nc) || vis[nid]) continue;
-                        if (user_grid_[nr][nc] > 0 || user_grid_[nr][nc] == -2) {
-                            vis[nid] = 1;
-                            q.push(cell(nr, nc));
-                        }
-                    }
-                }
+    cell_sets sets(rows * cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int id = r * cols + c;
+            int v = solution[r][c];
+            int col = colour(r, c);
+            if (col < 0) {
+                found.push_back({violation::bad_cell, cell(r, c), "недопустиме значення " + std::to_string(v) + at(r, c)});
+            } else if (puzzle[r][c] > 0 && v != puzzle[r][c]) {
+                found.push_back({violation::bad_cell, cell(r, c), "очікувалась підказка " + std::to_string(puzzle[r][c]) + at(r, c)});
+            } else if (puzzle[r][c] == 0 && v > 0) {
+                found.push_back({violation::bad_cell, cell(r, c), "у клітинці не було підказки" + at(r, c)});
+            }
+            if (v > 0) {
+                sets.clues[id] = 1;
+                sets.clue_sum[id] = v;
+                sets.first_clue[id] = id;
+            }
+            // Одночасно з розміткою: чорне вікно 2x2, правим нижнім кутом якого є ця клітинка
+            if (r > 0 && c > 0 && col == 0 && colour(r - 1, c - 1) == 0 && colour(r - 1, c) == 0 && colour(r, c - 1) == 0) {
+                found.push_back({violation::black_2x2, cell(r - 1, c - 1), "знайдено 2×2 чорний блок у клітині" + at(r - 1, c - 1)});
+            }
+            if (col < 0) continue;
+            if (c > 0 && colour(r, c - 1) == col) sets.unite(id, id - 1);
+            if (r > 0 && colour(r - 1, c) == col) sets.unite(id, id - cols);
+        }
+    }
 
-                // Якщо клітинок з підказками менше 2 - повертаємо false
-                if (start.row == -1 || end.row == -1) {
-                    reason = "острів має менше ніж 2 підказки";
-                    loc = (start.row != -1 ? start : (end.row != -1 ? end : cell(r, c)));
-                    return false;
-                }
+    // Перша клітинка кожної множини в порядку обходу - її "представник" у повідомленнях
+    std::vector<int> first(rows * cols, -1);
+    std::vector<int> roots;
+    for (int id = 0; id < rows * cols; ++id) {
+        if (colour(id / cols, id % cols) < 0) continue;
+        int root = sets.find(id);
+        if (first[root] < 0) {
+            first[root] = id;
+            roots.push_back(root);
+        }
+    }
 
-                // Якщо площа області не збігається з сумою клітинок з підказками - повертаємо false
-                int sum = user_grid_[start.row][start.col] + user_grid_[end.row][end.col];
-                if (sum != size) {
-                    reason = "площа острова (" + std::to_string(size) + ") не дорівнює сумі підказок: " + std::to_string(sum);
-                    loc = start;
-                    return false;
-                }
+    // Основна чорна область - найбільша компонента, решта повідомляються як відокремлені частини
+    int main_black = -1;
+    for (int root : roots) {
+        if (colour(first[root] / cols, first[root] % cols) == 0 && (main_black < 0 || sets.size[root] > sets.size[main_black]))
+            main_black = root;
+    }
+    for (int root : roots) {
+        int r = first[root] / cols, c = first[root] % cols;
+        if (colour(r, c) == 0) {
+            if (root != main_black) {
+                found.push_back({violation::black_split, cell(r, c),
+                                 "чорна область незв'язна: окрема частина з " + std::to_string(sets.size[root]) + " клітинок" + at(r, c)});
             }
+            continue;
+        }
+        cell loc = sets.first_clue[root] >= 0 ? cell(sets.first_clue[root] / cols, sets.first_clue[root] % cols) : cell(r, c);
+        if (sets.clues[root] > 2) {
+            found.push_back({violation::too_many_clues, loc, "острів має більше 2 підказки" + at(loc.row, loc.col)});
+        } else if (sets.clues[root] < 2) {
+            found.push_back({violation::too_few_clues, loc, "острів має менше ніж 2 підказки" + at(loc.row, loc.col)});
+        } else if (sets.size[root] != sets.clue_sum[root]) {
+            found.push_back({violation::wrong_size, loc,
+                             "площа острова (" + std::to_string(sets.size[root]) + ") не дорівнює сумі підказок: " +
+                             std::to_string(sets.clue_sum[root]) + at(loc.row, loc.col)});
         }
     }
-    return true;
+    return found;
+}
+
+std::vector<std::vector<user_solution_checker::violation>> user_solution_checker::validate_batch(
+        const std::vector<grid> &puzzles, const std::vector<grid> &solutions, int threads) {
+    if (puzzles.size() != solutions.size()) {
+        throw std::runtime_error("Кількість рішень не збігається з кількістю задач");
+    }
+    std::vector<std::vector<violation>> results(puzzles.size());
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Потоки забирають задачі по одній з спільного лічильника, тож великі сітки не гальмують решту
+    std::atomic<std::size_t> next{0};
+    auto work = [&] {
+        for (std::size_t i; (i = next++) < puzzles.size();) {
+            results[i] = validate(puzzles[i], solutions[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto &t : pool) t.join();
+    return results;
 }
@@ -7,9 +7,40 @@
 
 class user_solution_checker {
 public:
+    using grid = std::vector<std::vector<int>>;
+
+    // Порушення правил у рішенні
+    struct violation {
+        enum kind_t {
+            bad_cell,           // порожня або недопустима клітинка, змінена підказка
+            black_2x2,          // чорний блок 2x2 (loc - лівий верхній кут)
+            black_split,        // відокремлена частина чорної області (loc - її перша клітинка)
+            too_many_clues,     // острів має більше 2 підказок
+            too_few_clues,      // острів має менше 2 підказок
+            wrong_size          // площа острова не дорівнює сумі підказок
+        };
+        kind_t kind;
+        cell loc;
+        std::string reason;
+    };
+
     // Ініціалізація перевірки з початковою сіткою
     user_solution_checker(const std::vector<std::vector<int>> &initial_grid);
 
+    /*
+        Перевіряє рішення solution задачі puzzle без інтерактивного введення і повертає всі порушення
+        (порожній список - рішення правильне). Білі і чорні області розмічаються за один прохід
+        системою неперетинних множин, блоки 2x2 перевіряються в тому ж проході
+    */
+    static std::vector<violation> validate(const grid &puzzle, const grid &solution);
+
+    /*
+        Перевіряє багато рішень паралельно: результат i відповідає парі puzzles[i], solutions[i].
+        threads = 0 - за кількістю ядер
+    */
+    static std::vector<std::vector<violation>> validate_batch(const std::vector<grid> &puzzles,
+                                                              const std::vector<grid> &solutions, int threads = 0);
+
     /*
         Інтерактивне зчитування рішення та його перевірка
         Повертає true, якщо рішення коректне
@@ -27,21 +58,4 @@ private:
 
     // Фаза перевірки правильності введеного розв’язку
     bool validation_phase(std::ostream &out);
-
-    // Перевірка наявності чорного блока 2x2. Якщо знайдено — повертає координати верхнього лівого кута.
-    bool check_black_2x2_block(cell &lt) const;
-
-    // Перевірка зв’язності чорної області
-    bool check_black_connectivity() const;
-
-    // Перевірка коректності островів. У разі помилки повертає причину та місце.
-    bool check_islands(std::string &reason, cell &loc) const;
-
-    static constexpr int DR_[4] = {-1, 1, 0, 0};
-    static constexpr int DC_[4] = {0, 0, -1, 1};
-
-    // Перевірка виходу за межі сітки
-    bool out_of_bounds(int r, int c) const {
-        return r < 0 || c < 0 || r >= rows_ || c >= cols_;
-    }
 };